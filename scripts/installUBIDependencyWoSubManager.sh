@@ -73,6 +73,7 @@ if [ "${MODE}" == "base" ] ; then
         elfutils-libelf-devel \
         sparsehash-devel \
         snappy-devel \
+        libzstd-devel \
         jsoncpp-devel \
         glog-devel \
         llvm-toolset
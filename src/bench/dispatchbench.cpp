@@ -0,0 +1,146 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+
+/**
+ * Event dispatch microbenchmark. Replays scap traces through libsinsp once to
+ * record their event types and reports the replay rate, then runs the
+ * recorded types through the collector's dispatch table (handler lookup and
+ * early rejection of unhandled types) and reports events/sec for the
+ * dispatcher alone. It also reports how many of the replayed events would
+ * still be delivered with ENABLE_SYSCALL_PRUNING, since the driver event
+ * mask cannot be applied to trace files.
+ *
+ * Usage: dispatchbench [rounds] [trace.scap ...]
+ * Default traces: every .scap file in the subdirectories of ../tests
+ **/
+
+#include "eventdispatch.h"
+#include <chrono>
+#include <cstdlib>
+#include <glob.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+static bool replay(const std::string &path, std::vector<uint16_t> *types,
+                   double *secs) {
+  sinsp inspector;
+  try {
+    inspector.open(path);
+  } catch (sinsp_exception &e) {
+    std::cerr << "Unable to open " << path << ": " << e.what() << std::endl;
+    return false;
+  }
+  sinsp_evt *ev = nullptr;
+  auto start = steady_clock::now();
+  while (true) {
+    int32_t res = inspector.next(&ev);
+    if (res == SCAP_TIMEOUT) {
+      continue;
+    } else if (res != SCAP_SUCCESS) {
+      break;
+    }
+    types->push_back(ev->get_type());
+  }
+  *secs += duration<double>(steady_clock::now() - start).count();
+  inspector.close();
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int rounds = (argc > 1) ? atoi(argv[1]) : 100;
+  if (rounds <= 0) {
+    rounds = 100;
+  }
+  std::vector<std::string> traces;
+  for (int i = 2; i < argc; i++) {
+    traces.emplace_back(argv[i]);
+  }
+  if (traces.empty()) {
+    glob_t g;
+    if (glob("../tests/*/*.scap", 0, nullptr, &g) == 0) {
+      for (size_t i = 0; i < g.gl_pathc; i++) {
+        traces.emplace_back(g.gl_pathv[i]);
+      }
+    }
+    globfree(&g);
+  }
+  if (traces.empty()) {
+    std::cerr << "No scap traces found" << std::endl;
+    return 1;
+  }
+
+  std::vector<uint16_t> types;
+  double replaySecs = 0;
+  for (auto &t : traces) {
+    replay(t, &types, &replaySecs);
+  }
+  if (types.empty()) {
+    std::cerr << "No events read" << std::endl;
+    return 1;
+  }
+  std::cout << "Traces: " << traces.size() << " Events: " << types.size()
+            << std::endl;
+  std::cout << "sinsp replay: " << types.size() / replaySecs << " events/sec"
+            << std::endl;
+
+  dispatch::EventDispatchTable table;
+  uint64_t counts[4] = {0, 0, 0, 0};
+  uint64_t flags = 0;
+  auto start = steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (uint16_t type : types) {
+      const dispatch::Entry &de = table.lookup(type);
+      counts[de.handler]++;
+      if (de.handler != dispatch::H_NONE) {
+        flags ^= de.flag;
+      }
+    }
+  }
+  double secs = duration<double>(steady_clock::now() - start).count();
+  uint64_t total = static_cast<uint64_t>(types.size()) * rounds;
+  std::cout << "Handled event types: " << table.getNumHandled() << " of "
+            << PPM_EVENT_MAX << std::endl;
+  std::cout << "Dispatched: " << (total - counts[dispatch::H_NONE]) / rounds
+            << " Rejected early: " << counts[dispatch::H_NONE] / rounds
+            << std::endl;
+  std::cout << "Dispatcher: " << total / secs << " events/sec ("
+            << secs * 1e9 / total << " ns/event, check " << flags << ")"
+            << std::endl;
+
+  uint64_t delivered = 0;
+  for (uint16_t type : types) {
+    if (table.isRequired(type)) {
+      delivered++;
+    }
+  }
+  std::cout << "Syscall pruning: " << table.getNumRequired() << " of "
+            << PPM_EVENT_MAX << " event types required, delivered events "
+            << delivered << " of " << types.size() << " ("
+            << 100.0 * (types.size() - delivered) / types.size()
+            << "% fewer)" << std::endl;
+  std::cout << "Delivered events/sec over the replay: "
+            << types.size() / replaySecs << " -> " << delivered / replaySecs
+            << std::endl;
+  return 0;
+}
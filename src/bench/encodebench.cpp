@@ -0,0 +1,152 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+/**
+ * Measures heap allocations and time per record when encoding Process and
+ * NetworkFlow records through the SysFlow union (copy into the union, then
+ * encode) versus encoding them directly from the live object. Both paths
+ * must produce the same bytes.
+ *
+ * Usage: encodebench [iterations]
+ **/
+
+#include "avro/Encoder.hh"
+#include "avro/Specific.hh"
+#include "bufferstream.h"
+#include "sysflow.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static std::atomic<uint64_t> s_allocs(0);
+
+void *operator new(size_t size) {
+  s_allocs++;
+  void *p = std::malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+using sysflow::NetworkFlow;
+using sysflow::Process;
+using sysflow::SysFlow;
+
+struct Result {
+  double allocsPerRec;
+  double nsPerRec;
+};
+
+template <typename F> static Result run(int iters, F encodeOne) {
+  uint64_t allocs = s_allocs;
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < iters; i++) {
+    encodeOne();
+  }
+  auto end = std::chrono::steady_clock::now();
+  Result r;
+  r.allocsPerRec = static_cast<double>(s_allocs - allocs) / iters;
+  r.nsPerRec =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+          .count() /
+      static_cast<double>(iters);
+  return r;
+}
+
+template <typename T, typename S>
+static bool bench(const char *name, int iters, const T &rec, S setter) {
+  std::vector<uint8_t> unionBuf;
+  std::vector<uint8_t> directBuf;
+  unionBuf.reserve(4096);
+  directBuf.reserve(4096);
+  writer::BufferOutputStream unionOut(&unionBuf);
+  writer::BufferOutputStream directOut(&directBuf);
+  avro::EncoderPtr unionEnc = avro::binaryEncoder();
+  avro::EncoderPtr directEnc = avro::binaryEncoder();
+  unionEnc->init(unionOut);
+  directEnc->init(directOut);
+  SysFlow flow;
+  setter(flow, rec);
+  size_t idx = flow.rec.idx();
+
+  Result u = run(iters, [&]() {
+    unionBuf.clear();
+    setter(flow, rec);
+    avro::encode(*unionEnc, flow);
+    unionEnc->flush();
+  });
+  Result d = run(iters, [&]() {
+    directBuf.clear();
+    directEnc->encodeUnionIndex(idx);
+    avro::encode(*directEnc, rec);
+    directEnc->flush();
+  });
+  bool same = (unionBuf == directBuf);
+  std::cout << name << ": union " << u.allocsPerRec << " allocs/rec "
+            << u.nsPerRec << " ns/rec; direct " << d.allocsPerRec
+            << " allocs/rec " << d.nsPerRec << " ns/rec; bytes "
+            << (same ? "identical" : "DIFFER") << std::endl;
+  return same;
+}
+
+int main(int argc, char **argv) {
+  int iters = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+
+  Process proc;
+  proc.ts = 1600000000000000000;
+  proc.oid.hpid = 4242;
+  proc.oid.createTS = 1600000000000000000;
+  proc.exe = "/usr/lib/jvm/java-11-openjdk-amd64/bin/java";
+  proc.exeArgs = "-Xmx2g -Dlog4j.configurationFile=/etc/app/log4j2.xml -jar "
+                 "/opt/app/service.jar --spring.profiles.active=prod";
+  proc.uid = 1000;
+  proc.userName = "application-user";
+  proc.gid = 1000;
+  proc.groupName = "application-group";
+  proc.containerId.set_string("f3a1c0de9b7e");
+  proc.poid.set_null();
+
+  NetworkFlow nf;
+  nf.ts = 1600000000000000000;
+  nf.endTs = 1600000001000000000;
+  nf.procOID.hpid = 4242;
+  nf.procOID.createTS = 1600000000000000000;
+  nf.tid = 4243;
+  nf.fd = 12;
+  nf.opFlags = 1;
+  nf.sip = 0x0100007f;
+  nf.sport = 43210;
+  nf.dip = 0x0100007f;
+  nf.dport = 443;
+  nf.proto = 6;
+
+  bool ok = bench("Process", iters, proc, [](SysFlow &f, const Process &p) {
+    f.rec.set_Process(p);
+  });
+  ok &= bench("NetworkFlow", iters, nf,
+              [](SysFlow &f, const NetworkFlow &n) {
+                f.rec.set_NetworkFlow(n);
+              });
+  return ok ? 0 : 1;
+}
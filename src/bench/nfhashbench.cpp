@@ -0,0 +1,269 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+/**
+ * Network flow key microbenchmark. For synthetic client, server, loopback,
+ * IPv6 and dual-stack 5-tuple distributions it reports ns/hash and bucket
+ * collisions in a power-of-two table (as used by dense_hash_map) relative to
+ * an ideal random hash, for the current key and, on IPv4 sets, for the
+ * original padded key hashed with MurmurHash3_x86_32. It then measures the
+ * per-event cost of building a key from a socket tuple and probing a flow
+ * table on IPv4-only and mixed traces.
+ *
+ * Usage: nfhashbench [keys]
+ **/
+
+#include "MurmurHash3.h"
+#include "flowkey.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// socket tuple as exposed by sinsp fdinfo.
+struct Tuple {
+  bool v6;
+  uint32_t sip[4];
+  uint32_t dip[4];
+  uint16_t sport;
+  uint16_t dport;
+  uint64_t tid;
+  uint32_t fd;
+};
+
+struct LegacyNFKey {
+  uint64_t tid;
+  uint32_t ip1;
+  uint16_t port1;
+  uint32_t ip2;
+  uint16_t port2;
+  uint32_t fd;
+};
+
+struct LegacyHasher {
+  size_t operator()(const LegacyNFKey &k) const {
+    size_t hash = 0;
+    MurmurHash3_x86_32(&k, sizeof(LegacyNFKey), 0, &hash);
+    return hash;
+  }
+};
+
+typedef std::unordered_map<NFKey, int, NFKeyHasher, eqnfkey> FlowTable;
+
+static inline NFKey toKey(const Tuple &t) {
+  NFKey k;
+  k.tid = t.tid;
+  k.fd = t.fd;
+  k.ip1 = t.v6 ? nfaddr(t.sip) : nfaddr4(t.sip[3]);
+  k.ip2 = t.v6 ? nfaddr(t.dip) : nfaddr4(t.dip[3]);
+  k.port1 = t.sport;
+  k.port2 = t.dport;
+  return k;
+}
+
+static LegacyNFKey toLegacy(const Tuple &t, uint8_t junk) {
+  LegacyNFKey l;
+  // keys were reused without clearing their padding.
+  std::memset(&l, junk, sizeof(l));
+  l.tid = t.tid;
+  l.ip1 = t.sip[3];
+  l.port1 = t.sport;
+  l.ip2 = t.dip[3];
+  l.port2 = t.dport;
+  l.fd = t.fd;
+  return l;
+}
+
+static Tuple v4(uint64_t tid, uint32_t sip, uint16_t sport, uint32_t dip,
+                uint16_t dport, uint32_t fd) {
+  Tuple t = {false, {0, 0, 0, htonl(sip)}, {0, 0, 0, htonl(dip)},
+             sport, dport, tid, fd};
+  return t;
+}
+
+static Tuple v6(uint64_t tid, uint64_t sipHi, uint64_t sipLo, uint16_t sport,
+                uint64_t dipHi, uint64_t dipLo, uint16_t dport, uint32_t fd) {
+  Tuple t = {true,
+             {htonl(sipHi >> 32), htonl(sipHi), htonl(sipLo >> 32),
+              htonl(sipLo)},
+             {htonl(dipHi >> 32), htonl(dipHi), htonl(dipLo >> 32),
+              htonl(dipLo)},
+             sport, dport, tid, fd};
+  return t;
+}
+
+static std::vector<Tuple> client(size_t n, std::mt19937 &rng) {
+  const uint32_t services[] = {0x0a000a01, 0x0a000a02, 0x0a000b07};
+  const uint16_t ports[] = {443, 5432, 6379};
+  std::vector<Tuple> ts;
+  for (size_t i = 0; i < n; i++) {
+    size_t s = rng() % 3;
+    ts.push_back(v4(20000 + rng() % 16, 0x0a010203, 32768 + i % 28000,
+                    services[s], ports[s], 3 + i));
+  }
+  return ts;
+}
+
+static std::vector<Tuple> server(size_t n, std::mt19937 &rng) {
+  std::vector<Tuple> ts;
+  for (size_t i = 0; i < n; i++) {
+    ts.push_back(v4(31000 + rng() % 64, 0x0a000000 | (rng() & 0xffff),
+                    32768 + rng() % 28232, 0x0a0a0005, 8080, 10 + i));
+  }
+  return ts;
+}
+
+static std::vector<Tuple> loopback(size_t n, std::mt19937 &rng) {
+  std::vector<Tuple> ts;
+  for (size_t i = 0; i < n; i++) {
+    ts.push_back(v4(4000 + rng() % 4, 0x7f000001, 40000 + i % 25000,
+                    0x7f000001, 15001, 5 + i / 25000));
+  }
+  return ts;
+}
+
+// pods on a dual-stack cluster: fd00:10:244::/64 addresses, a few services.
+static std::vector<Tuple> server6(size_t n, std::mt19937 &rng) {
+  std::vector<Tuple> ts;
+  for (size_t i = 0; i < n; i++) {
+    ts.push_back(v6(31000 + rng() % 64, 0xfd00001002440000ULL,
+                    (static_cast<uint64_t>(rng()) << 32) | rng(),
+                    32768 + rng() % 28232, 0xfd00001002440000ULL, 0x15, 8080,
+                    10 + i));
+  }
+  return ts;
+}
+
+// half IPv4, a quarter native IPv6, a quarter v4-mapped IPv6 sockets.
+static std::vector<Tuple> mixed(size_t n, std::mt19937 &rng) {
+  std::vector<Tuple> a = server(n / 2, rng);
+  std::vector<Tuple> b = server6(n / 4, rng);
+  std::vector<Tuple> c = client(n - a.size() - b.size(), rng);
+  for (auto it = c.begin(); it != c.end(); ++it) {
+    it->v6 = true;
+    it->sip[2] = it->dip[2] = htonl(0xffff);
+    it->fd += n;
+  }
+  std::vector<Tuple> ts;
+  ts.insert(ts.end(), a.begin(), a.end());
+  ts.insert(ts.end(), b.begin(), b.end());
+  ts.insert(ts.end(), c.begin(), c.end());
+  std::shuffle(ts.begin(), ts.end(), rng);
+  return ts;
+}
+
+template <typename K, typename H>
+static void quality(const char *name, const std::vector<K> &keys, H hasher) {
+  size_t buckets = 1;
+  while (buckets < keys.size() * 2) {
+    buckets <<= 1;
+  }
+  std::vector<uint8_t> used(buckets, 0);
+  size_t collisions = 0;
+  for (auto it = keys.begin(); it != keys.end(); ++it) {
+    size_t b = hasher(*it) & (buckets - 1);
+    if (used[b] != 0) {
+      collisions++;
+    }
+    used[b] = 1;
+  }
+  double n = keys.size();
+  double ideal = n - buckets * (1 - std::pow(1 - 1.0 / buckets, n));
+  volatile size_t sink = 0;
+  int reps = 20;
+  auto begin = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; r++) {
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+      sink = sink + hasher(*it);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+          .count() /
+      (n * reps);
+  std::cout << "  " << name << ": " << ns << " ns/hash, collisions "
+            << collisions << " (ideal " << static_cast<size_t>(ideal) << ")"
+            << std::endl;
+}
+
+// builds the key from the tuple and probes the table, as handleNetFlowEvent
+// does for every send/recv.
+static void perEvent(const char *name, const std::vector<Tuple> &flows,
+                     std::mt19937 &rng) {
+  FlowTable table;
+  for (auto it = flows.begin(); it != flows.end(); ++it) {
+    table[toKey(*it)] = 1;
+  }
+  std::vector<uint32_t> events(flows.size() * 10);
+  for (auto it = events.begin(); it != events.end(); ++it) {
+    *it = rng() % flows.size();
+  }
+  size_t hits = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (auto it = events.begin(); it != events.end(); ++it) {
+    NFKey key = toKey(flows[*it]);
+    hits += table.count(key);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+          .count() /
+      static_cast<double>(events.size());
+  std::cout << "  " << name << ": " << ns << " ns/event ("
+            << hits * 100.0 / events.size() << "% hits)" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  std::mt19937 rng(42);
+  struct {
+    const char *name;
+    std::vector<Tuple> tuples;
+    bool v4only;
+  } sets[] = {{"client", client(n, rng), true},
+              {"server", server(n, rng), true},
+              {"loopback", loopback(n, rng), true},
+              {"ipv6 server", server6(n, rng), false},
+              {"dual-stack", mixed(n, rng), false}};
+  for (auto &s : sets) {
+    std::cout << s.name << " (" << n << " keys)" << std::endl;
+    if (s.v4only) {
+      std::vector<LegacyNFKey> legacy;
+      for (auto it = s.tuples.begin(); it != s.tuples.end(); ++it) {
+        legacy.push_back(toLegacy(*it, static_cast<uint8_t>(rng())));
+      }
+      quality("murmur3 padded v4 key", legacy, LegacyHasher());
+    }
+    std::vector<NFKey> keys;
+    for (auto it = s.tuples.begin(); it != s.tuples.end(); ++it) {
+      keys.push_back(toKey(*it));
+    }
+    quality("mix64 unified key", keys, NFKeyHasher());
+  }
+  std::cout << "per event lookup" << std::endl;
+  perEvent("ipv4 only", sets[1].tuples, rng);
+  perEvent("dual-stack", sets[4].tuples, rng);
+  return 0;
+}
@@ -0,0 +1,56 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_BUFFER_STREAM_
+#define __SF_BUFFER_STREAM_
+#include "avro/Stream.hh"
+#include <cstdint>
+#include <vector>
+
+#define BUFFER_STREAM_CHUNK 256
+
+namespace writer {
+/**
+ * avro output stream appending into a caller owned byte vector. The vector
+ * can be cleared between records; its capacity is kept, so steady state
+ * encoding does not allocate.
+ **/
+class BufferOutputStream : public avro::OutputStream {
+private:
+  std::vector<uint8_t> *m_buf;
+  size_t m_chunk;
+
+public:
+  explicit BufferOutputStream(std::vector<uint8_t> *buf,
+                              size_t chunk = BUFFER_STREAM_CHUNK)
+      : m_buf(buf), m_chunk(chunk) {}
+  inline void setBuffer(std::vector<uint8_t> *buf) { m_buf = buf; }
+  bool next(uint8_t **data, size_t *len) {
+    size_t off = m_buf->size();
+    m_buf->resize(off + m_chunk);
+    *data = m_buf->data() + off;
+    *len = m_chunk;
+    return true;
+  }
+  void backup(size_t len) { m_buf->resize(m_buf->size() - len); }
+  uint64_t byteCount() const { return m_buf->size(); }
+  void flush() {}
+};
+} // namespace writer
+#endif
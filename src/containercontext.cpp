@@ -84,9 +84,9 @@ bool ContainerContext::exportContainer(const string &id) {
   bool exprt = false;
   ContainerTable::iterator cont = m_containers.find(id);
   if (cont != m_containers.end()) {
-    if (!cont->second->written) {
+    if (cont->second->epoch != m_writer->getEpoch()) {
       m_writer->writeContainer(&(cont->second->cont));
-      cont->second->written = true;
+      cont->second->epoch = m_writer->getEpoch();
       exprt = true;
     }
   }
@@ -111,7 +111,8 @@ ContainerObj *ContainerContext::getContainer(sinsp_threadinfo *ti) {
   ContainerObj *ct = nullptr;
   ContainerTable::iterator cont = m_containers.find(ti->m_container_id);
   if (cont != m_containers.end()) {
-    if (cont->second->written && !cont->second->incomplete) {
+    bool written = (cont->second->epoch == m_writer->getEpoch());
+    if (written && !cont->second->incomplete) {
       return cont->second;
     }
     const sinsp_container_info::ptr_t container =
@@ -122,7 +123,7 @@ ContainerObj *ContainerContext::getContainer(sinsp_threadinfo *ti) {
       // delete cont->second;
       return cont->second;
     }
-    if (cont->second->written && cont->second->incomplete) {
+    if (written && cont->second->incomplete) {
       SF_DEBUG(m_logger,
                "Container is written and includes name: " << container->m_name);
       if (container->m_name.compare(INCOMPLETE) == 0 ||
@@ -143,20 +144,28 @@ ContainerObj *ContainerContext::getContainer(sinsp_threadinfo *ti) {
   }
   m_containers[ct->cont.id] = ct;
   m_writer->writeContainer(&(ct->cont));
-  ct->written = true;
+  ct->epoch = m_writer->getEpoch();
   return ct;
 }
 
-void ContainerContext::clearContainers() {
-  for (ContainerTable::iterator it = m_containers.begin();
-       it != m_containers.end(); ++it) {
-    if (it->second->refs == 0) {
+// Evicts up to budget containers that no process refers to and whose record
+// was not written in the current file.
+int ContainerContext::sweep(int budget) {
+  int removed = 0;
+  for (; budget > 0; --budget) {
+    ContainerTable::iterator it =
+        m_sweep.next(m_containers, m_writer->getEpoch());
+    if (it == m_containers.end()) {
+      break;
+    }
+    ContainerObj *ct = it->second;
+    if (ct->refs == 0 && ct->epoch != m_writer->getEpoch()) {
       m_containers.erase(it);
-      delete it->second;
-    } else {
-      it->second->written = false;
+      delete ct;
+      removed++;
     }
   }
+  return removed;
 }
 
 void ContainerContext::clearAllContainers() {
@@ -22,6 +22,7 @@
 #include <string>
 
 #include "datatypes.h"
+#include "sweepcursor.h"
 #include "sysflow.h"
 #include "sysflowcontext.h"
 #include "sysflowwriter.h"
@@ -35,6 +36,7 @@ namespace container {
 class ContainerContext {
 private:
   ContainerTable m_containers;
+  table::SweepCursor<ContainerTable> m_sweep;
   context::SysFlowContext *m_cxt;
   writer::SysFlowWriter *m_writer;
   ContainerObj *createContainer(sinsp_threadinfo *ti);
@@ -48,7 +50,7 @@ public:
   bool exportContainer(const string &id);
   int derefContainer(const string &id);
   void clearAllContainers();
-  void clearContainers();
+  int sweep(int budget);
   inline int getSize() { return m_containers.size(); }
 };
 } // namespace container
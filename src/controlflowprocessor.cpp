@@ -64,7 +64,7 @@ inline void ControlFlowProcessor::processNewFlow(sinsp_evt *ev,
   populateProcFlow(pf, flag, ev, proc);
   updateProcFlow(pf, flag, ev);
   proc->pfo = pf;
-  m_pfSet->insert(proc);
+  m_pfSet->schedule(proc, pf->exportTime + m_cxt->getNFExportInterval());
 }
 
 inline void ControlFlowProcessor::populateProcFlow(ProcessFlowObj *pf,
@@ -100,7 +100,7 @@ inline void ControlFlowProcessor::updateProcFlow(ProcessFlowObj *pf,
 inline void ControlFlowProcessor::removeAndWriteProcessFlow(ProcessObj *proc) {
   // SF_INFO(m_logger, "removeAndWriteProcessFlow")
   m_writer->writeProcessFlow(&((proc->pfo)->procflow));
-  m_processCxt->removeProcessFromSet(proc, true);
+  m_processCxt->removeProcessFromSet(proc);
   proc->pfo = nullptr;
 }
 
@@ -175,6 +175,7 @@ int ControlFlowProcessor::checkForExpiredRecords() {
   time_t now = utils::getCurrentTime(m_cxt);
   if (m_lastCheck == 0) {
     m_lastCheck = now;
+    m_pfSet->advance(now);
     return 0;
   }
   if (difftime(now, m_lastCheck) < 1.0) {
@@ -183,32 +184,20 @@ int ControlFlowProcessor::checkForExpiredRecords() {
   m_lastCheck = now;
   int i = 0;
   SF_DEBUG(m_logger, "Checking expired PROC Flows!!!....");
-  for (auto it = m_pfSet->begin(); it != m_pfSet->end();) {
-    // SF_INFO(m_logger, "Checking flow with exportTime: " <<
-    // (*it)->pfo->exportTime
-    //                                                   << " Now: " << now);
-    if (difftime(now, (*it)->pfo->exportTime) >= m_cxt->getNFExportInterval()) {
-      SF_DEBUG(m_logger, "Exporting Proc flow!!! ");
-      if (difftime(now, (*it)->pfo->lastUpdate) >=
-          m_cxt->getNFExpireInterval()) {
-        //	SF_INFO(m_logger, "Deleting processflow...")
-        //	SF_INFO(m_logger, "NOW: " << now << " LastUpdate: " <<
-        //(*it)->pfo->lastUpdate);
-        delete (*it)->pfo;
-        (*it)->pfo = nullptr;
-        it = m_pfSet->erase(it);
-      } else {
-        //	SF_INFO(m_logger, "Exporting processflow...checkForExpired")
-        exportProcessFlow((*it)->pfo);
-        ProcessObj *p = (*it);
-        it = m_pfSet->erase(it);
-        p->pfo->exportTime = utils::getCurrentTime(m_cxt);
-        m_pfSet->insert(p);
-      }
-      i++;
+  m_pfSet->advance(now);
+  ProcessObj *p = nullptr;
+  while ((p = m_pfSet->popExpired()) != nullptr) {
+    SF_DEBUG(m_logger, "Exporting Proc flow!!! ");
+    if (difftime(now, p->pfo->lastUpdate) >= m_cxt->getNFExpireInterval()) {
+      delete p->pfo;
+      p->pfo = nullptr;
     } else {
-      break;
+      exportProcessFlow(p->pfo);
+      p->pfo->exportTime = utils::getCurrentTime(m_cxt);
+      m_pfSet->schedule(p,
+                        p->pfo->exportTime + m_cxt->getNFExportInterval());
     }
+    i++;
   }
   return i;
 }
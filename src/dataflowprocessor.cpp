@@ -35,7 +35,7 @@ DataFlowProcessor::DataFlowProcessor(context::SysFlowContext *cxt,
   m_fileflowPrcr = new fileflow::FileFlowProcessor(cxt, writer, processCxt,
                                                    &m_dfSet, fileCxt);
   m_fileevtPrcr =
-      new fileevent::FileEventProcessor(writer, processCxt, fileCxt);
+      new fileevent::FileEventProcessor(cxt, writer, processCxt, fileCxt);
   m_lastCheck = 0;
 }
 
@@ -87,13 +87,27 @@ int DataFlowProcessor::removeAndWriteDFFromProc(ProcessObj *proc, int64_t tid) {
 
 void DataFlowProcessor::printFlowStats() {
   m_procCxt->printStats();
-  SF_INFO(m_logger, "DF Set: " << m_dfSet.size());
+  SF_INFO(m_logger, "DF Set: " << m_dfSet.size() << " IPv6 Flows Not Written: "
+                                << m_netflowPrcr->getNumV6Flows());
+  std::vector<pool::PoolStats *> &pools = pool::getPools();
+  for (auto it = pools.begin(); it != pools.end(); ++it) {
+    pool::PoolStats *ps = *it;
+    SF_INFO(m_logger, "Pool: " << ps->name << " Object Size: " << ps->objSize
+                               << " Slabs: " << ps->slabs
+                               << " Slab Bytes: " << ps->getSlabBytes()
+                               << " Capacity: " << ps->capacity
+                               << " In Use: " << ps->inUse
+                               << " Peak: " << ps->peak
+                               << " Allocs: " << ps->allocs
+                               << " Frees: " << ps->frees);
+  }
 }
 
 int DataFlowProcessor::checkForExpiredRecords() {
   time_t now = utils::getCurrentTime(m_cxt);
   if (m_lastCheck == 0) {
     m_lastCheck = now;
+    m_dfSet.advance(now);
     return 0;
   }
   if (difftime(now, m_lastCheck) < 1.0) {
@@ -102,33 +116,27 @@ int DataFlowProcessor::checkForExpiredRecords() {
   m_lastCheck = now;
   int i = 0;
   SF_DEBUG(m_logger, "Checking expired Flows!!!....");
-  for (auto it = m_dfSet.begin(); it != m_dfSet.end();) {
-    SF_DEBUG(m_logger, "Checking flow with exportTime: " << (*it)->exportTime
-                                                         << " Now: " << now);
-    if (difftime(now, (*it)->exportTime) >= m_cxt->getNFExportInterval()) {
-      SF_DEBUG(m_logger, "Exporting flow!!! ");
-      if (difftime(now, (*it)->lastUpdate) >= m_cxt->getNFExpireInterval()) {
-        if ((*it)->isNetworkFlow) {
-          m_netflowPrcr->removeNetworkFlow((*it));
-        } else {
-          m_fileflowPrcr->removeFileFlow((*it));
-        }
-        it = m_dfSet.erase(it);
+  m_dfSet.advance(now);
+  DataFlowObj *dfo = nullptr;
+  while ((dfo = m_dfSet.popExpired()) != nullptr) {
+    SF_DEBUG(m_logger, "Exporting flow with exportTime: " << dfo->exportTime
+                                                          << " Now: " << now);
+    if (difftime(now, dfo->lastUpdate) >= m_cxt->getNFExpireInterval()) {
+      if (dfo->isNetworkFlow) {
+        m_netflowPrcr->removeNetworkFlow(dfo);
       } else {
-        if ((*it)->isNetworkFlow) {
-          m_netflowPrcr->exportNetworkFlow((*it), now);
-        } else {
-          m_fileflowPrcr->exportFileFlow((*it), now);
-        }
-        DataFlowObj *dfo = (*it);
-        it = m_dfSet.erase(it);
-        dfo->exportTime = utils::getCurrentTime(m_cxt);
-        m_dfSet.insert(dfo);
+        m_fileflowPrcr->removeFileFlow(dfo);
       }
-      i++;
     } else {
-      break;
+      if (dfo->isNetworkFlow) {
+        m_netflowPrcr->exportNetworkFlow(dfo, now);
+      } else {
+        m_fileflowPrcr->exportFileFlow(dfo, now);
+      }
+      dfo->exportTime = utils::getCurrentTime(m_cxt);
+      m_dfSet.schedule(dfo, dfo->exportTime + m_cxt->getNFExportInterval());
     }
+    i++;
   }
   return i;
 }
@@ -20,7 +20,11 @@
 #ifndef __HASHER__
 #define __HASHER__
 #include "MurmurHash3.h"
+#include "flowkey.h"
+#include "inlinetable.h"
+#include "objectpool.h"
 #include "sysflow.h"
+#include "timerwheel.h"
 #include "utils.h"
 #include <google/dense_hash_map>
 #include <google/dense_hash_set>
@@ -33,15 +37,6 @@ using sysflow::ProcessFlow;
 using sysflow::OID;
 using sysflow::Process;
 
-struct NFKey {
-  uint64_t tid;
-  uint32_t ip1;
-  uint16_t port1;
-  uint32_t ip2;
-  uint16_t port2;
-  uint32_t fd;
-};
-
 class OIDObj {
 public:
   time_t exportTime;
@@ -52,66 +47,51 @@ public:
   }
 };
 
-class DataFlowObj {
+class DataFlowObj : public timer::TimerNode {
 public:
   time_t exportTime;
   time_t lastUpdate;
   bool isNetworkFlow;
+  // ring of flows of the same process sharing this flow's key except the tid.
+  DataFlowObj *sibPrev;
+  DataFlowObj *sibNext;
   explicit DataFlowObj(bool inf)
-      : exportTime(0), lastUpdate(0), isNetworkFlow(inf) {}
+      : exportTime(0), lastUpdate(0), isNetworkFlow(inf), sibPrev(nullptr),
+        sibNext(nullptr) {}
 };
 
 class NetFlowObj : public DataFlowObj {
 public:
   NetworkFlow netflow;
-  bool operator==(const NetFlowObj &nfo) {
-    if (exportTime != nfo.exportTime) {
-      return false;
-    }
-
-    return (netflow.procOID.createTS == nfo.netflow.procOID.createTS &&
-            netflow.procOID.hpid == nfo.netflow.procOID.hpid &&
-            netflow.sip == nfo.netflow.sip && netflow.dip == nfo.netflow.dip &&
-            netflow.sport == nfo.netflow.sport &&
-            netflow.dport == nfo.netflow.dport &&
-            netflow.proto == nfo.netflow.proto &&
-            netflow.opFlags == nfo.netflow.opFlags &&
-            netflow.ts == nfo.netflow.ts && netflow.tid == nfo.netflow.tid &&
-            netflow.fd == nfo.netflow.fd);
+  // flow table key; holds the full addresses of IPv6 flows, which the
+  // NetworkFlow record cannot.
+  NFKey key;
+  NetFlowObj() : DataFlowObj(true), key() {}
+  // native IPv6 flows are tracked but have no NetworkFlow representation.
+  inline bool hasV4Tuple() const {
+    return isV4Addr(key.ip1) && isV4Addr(key.ip2);
   }
-  NetFlowObj() : DataFlowObj(true) {}
+  POOLED_OBJECT(NetFlowObj)
 };
 
+class FileObj;
+
 class FileFlowObj : public DataFlowObj {
 public:
   FileFlow fileflow;
-  string filekey;
-  string flowkey;
-  bool operator==(const FileFlowObj &ffo) {
-    if (exportTime != ffo.exportTime) {
-      return false;
-    }
-    return (fileflow.procOID.createTS == ffo.fileflow.procOID.createTS &&
-            fileflow.procOID.hpid == ffo.fileflow.procOID.hpid &&
-            fileflow.ts == ffo.fileflow.ts &&
-            fileflow.tid == ffo.fileflow.tid &&
-            fileflow.fd  == ffo.fileflow.fd &&
-            fileflow.opFlags == ffo.fileflow.opFlags &&
-            fileflow.openFlags == ffo.fileflow.openFlags &&
-            flowkey.compare(ffo.flowkey) == 0);
-  }
-  FileFlowObj() : DataFlowObj(false) {}
+  // pinned by FileObj::refs while the flow is tracked.
+  FileObj *file;
+  FFKey flowkey;
+  // path matched one of the FILE_READS_SELECT prefixes at creation.
+  bool selectPath;
+  FileFlowObj()
+      : DataFlowObj(false), file(nullptr), flowkey(), selectPath(false) {}
+  POOLED_OBJECT(FileFlowObj)
 };
 
 class ProcessFlowObj : public DataFlowObj {
 public:
   ProcessFlow procflow;
-  bool operator==(const ProcessFlowObj &pfo) {
-    if (exportTime != pfo.exportTime) {
-      return false;
-    }
-    return (procflow.procOID.createTS == pfo.procflow.procOID.createTS && procflow.procOID.hpid == pfo.procflow.procOID.hpid);
-  }
   ProcessFlowObj() : DataFlowObj(false) {}
 };
 
@@ -131,13 +111,6 @@ template <> struct MurmurHasher<OID *> {
     return hash;
   }
 };
-template <> struct MurmurHasher<NFKey *> {
-  size_t operator()(const NFKey *t) const {
-    size_t hash;
-    MurmurHash3_x86_32((void *)t, sizeof(NFKey), 0, &hash);
-    return hash;
-  }
-};
 
 struct eqoidptr {
   bool operator()(const OID *s1, const OID *s2) const {
@@ -165,39 +138,64 @@ struct eqstr {
   }
 };
 
-template <> struct MurmurHasher<NFKey> {
-  size_t operator()(const NFKey &t) const {
-    size_t hash = 0;
-    MurmurHash3_x86_32((void *)&t, sizeof(NFKey), 0, &hash);
-    return hash;
-  }
-};
 
-struct eqnfkey {
-  bool operator()(const NFKey &n1, const NFKey &n2) const {
-    return (n1.ip1 == n2.ip1 && n1.ip2 == n2.ip2 && n1.port1 == n2.port1 &&
-            n1.port2 == n2.port2 && n1.tid == n2.tid && n1.fd == n2.fd);
-  }
-};
-
-struct eqdfobj {
-  bool operator()(const DataFlowObj *df1, const DataFlowObj *df2) const {
-    return (df1->exportTime < df2->exportTime);
-  }
-};
 
 class FileObj {
 public:
-  bool written{false};
+  // writer epoch in which the file record was last written.
+  uint64_t epoch{0};
+  // CLOCK reference bit: set when the file is looked up, cleared when the
+  // eviction hand passes it.
+  bool recent{false};
   uint32_t refs{0};
-  string key;
+  uint64_t id{0};
+  string containerId;
   sysflow::File file;
   FileObj() {}
+  POOLED_OBJECT(FileObj)
+};
+
+// (container id, path) identity of a file. Table entries point at the
+// strings owned by their FileObj; lookups point at the event's strings, so
+// probing allocates nothing. The hash is computed once per key.
+struct FileKey {
+  size_t hash;
+  const string *cid;
+  const string *path;
+};
+
+inline FileKey makeFileKey(const string &cid, const string &path) {
+  FileKey key;
+  uint32_t seed = 0;
+  MurmurHash3_x86_32(cid.c_str(), cid.size(), 0, &seed);
+  key.hash = 0;
+  MurmurHash3_x86_32(path.c_str(), path.size(), seed, &key.hash);
+  key.cid = &cid;
+  key.path = &path;
+  return key;
+}
+
+struct FileKeyHasher {
+  size_t operator()(const FileKey &k) const { return k.hash; }
+};
+
+// empty and deleted keys have no strings and differ only by hash.
+struct eqfilekey {
+  bool operator()(const FileKey &k1, const FileKey &k2) const {
+    if (k1.hash != k2.hash) {
+      return false;
+    }
+    if (k1.path == nullptr || k2.path == nullptr) {
+      return k1.path == k2.path;
+    }
+    return (*k1.path == *k2.path && *k1.cid == *k2.cid);
+  }
 };
 
 class ContainerObj {
 public:
-  bool written{false};
+  // writer epoch in which the container record was last written.
+  uint64_t epoch{0};
   bool incomplete{false};
   uint32_t refs{0};
   Container cont;
@@ -208,56 +206,144 @@ typedef google::dense_hash_map<int, string> ParameterMapping;
 typedef google::dense_hash_map<string, ContainerObj *, MurmurHasher<string>,
                                eqstr>
     ContainerTable;
-typedef google::dense_hash_map<NFKey, NetFlowObj *, MurmurHasher<NFKey>,
-                               eqnfkey>
-    NetworkFlowTable;
-typedef google::dense_hash_map<string, FileFlowObj *, MurmurHasher<string>,
-                               eqstr>
-    FileFlowTable;
-typedef google::dense_hash_map<string, FileObj *, MurmurHasher<string>, eqstr>
+typedef google::dense_hash_map<NFKey, NetFlowObj *, NFKeyHasher, eqnfkey>
+    NetworkFlowMap;
+typedef google::dense_hash_map<FFKey, FileFlowObj *, FFKeyHasher, eqffkey>
+    FileFlowMap;
+typedef google::dense_hash_set<OID, MurmurHasher<OID>, eqoid> ProcessOIDSet;
+// sibling group key -> one flow of the group's ring.
+typedef google::dense_hash_map<NFKey, DataFlowObj *, NFKeyHasher, eqnfkey>
+    NetworkFlowGroupMap;
+typedef google::dense_hash_map<FFKey, DataFlowObj *, FFKeyHasher, eqffkey>
+    FileFlowGroupMap;
+
+struct NetworkFlowMapInit {
+  template <typename M> static void init(M *m) {
+    m->set_empty_key(*utils::getNFEmptyKey());
+    m->set_deleted_key(*utils::getNFDelKey());
+  }
+};
+struct FileFlowMapInit {
+  template <typename M> static void init(M *m) {
+    m->set_empty_key(*utils::getFFEmptyKey());
+    m->set_deleted_key(*utils::getFFDelKey());
+  }
+};
+struct ProcessOIDSetInit {
+  static void init(ProcessOIDSet *s) {
+    s->set_empty_key(*utils::getOIDEmptyKey());
+    s->set_deleted_key(*utils::getOIDDelKey());
+  }
+};
+
+// per-process tables, promoted to hash tables past INLINE_TABLE_SIZE entries.
+typedef table::InlineMap<NetworkFlowMap, NetworkFlowMapInit> NetworkFlowTable;
+typedef table::InlineMap<FileFlowMap, FileFlowMapInit> FileFlowTable;
+typedef table::InlineMap<NetworkFlowGroupMap, NetworkFlowMapInit>
+    NetworkFlowGroups;
+typedef table::InlineMap<FileFlowGroupMap, FileFlowMapInit> FileFlowGroups;
+
+// sibling group maps of a process (see linkSibling).
+struct FlowGroups {
+  NetworkFlowGroups nf;
+  FileFlowGroups ff;
+};
+
+// flows of different threads on the same socket or file descriptor share a
+// sibling key, which is their flow key with the tid cleared.
+inline NFKey siblingKey(const NFKey &k) {
+  NFKey g = k;
+  g.tid = 0;
+  return g;
+}
+
+inline FFKey siblingKey(const FFKey &k) {
+  FFKey g = k;
+  g.tid = 0;
+  return g;
+}
+
+template <typename Groups, typename Key>
+inline void linkSibling(Groups *groups, const Key &key, DataFlowObj *dfo) {
+  typename Groups::iterator it = groups->find(siblingKey(key));
+  if (it == groups->end()) {
+    dfo->sibPrev = dfo;
+    dfo->sibNext = dfo;
+    (*groups)[siblingKey(key)] = dfo;
+    return;
+  }
+  DataFlowObj *head = it->second;
+  dfo->sibNext = head;
+  dfo->sibPrev = head->sibPrev;
+  head->sibPrev->sibNext = dfo;
+  head->sibPrev = dfo;
+}
+
+template <typename Groups, typename Key>
+inline void unlinkSibling(Groups *groups, const Key &key, DataFlowObj *dfo) {
+  if (dfo->sibNext == nullptr) {
+    return;
+  }
+  if (dfo->sibNext == dfo) {
+    groups->erase(siblingKey(key));
+  } else {
+    dfo->sibPrev->sibNext = dfo->sibNext;
+    dfo->sibNext->sibPrev = dfo->sibPrev;
+    typename Groups::iterator it = groups->find(siblingKey(key));
+    if (it != groups->end() && it->second == dfo) {
+      it->second = dfo->sibNext;
+    }
+  }
+  dfo->sibPrev = nullptr;
+  dfo->sibNext = nullptr;
+}
+typedef google::dense_hash_map<FileKey, FileObj *, FileKeyHasher, eqfilekey>
     FileTable;
 typedef google::dense_hash_map<OID, NetworkFlowTable *, MurmurHasher<OID>,
                                eqoid>
     OIDNetworkTable;
-typedef google::dense_hash_set<OID, MurmurHasher<OID>, eqoid> ProcessSet;
-typedef multiset<DataFlowObj *, eqdfobj> DataFlowSet;
+// most processes have at most a couple of live children.
+typedef table::InlineSet<ProcessOIDSet, ProcessOIDSetInit, 2> ProcessSet;
+typedef timer::TimerWheel<DataFlowObj> DataFlowSet;
 typedef std::list<OIDObj *> OIDQueue;
-class ProcessObj {
+
+class ProcessObj : public timer::TimerNode {
 public:
-  bool written{false};
+  // writer epochs (see SysFlowWriter::getEpoch) in which this process
+  // record, and the records of all its ancestors, were last written.
+  uint64_t writtenEpoch{0};
+  uint64_t chainEpoch{0};
   Process proc;
   NetworkFlowTable netflows;
   FileFlowTable fileflows;
+  // allocated with the first flow, since most processes never hold one.
+  FlowGroups *groups;
   ProcessSet children;
   ProcessFlowObj* pfo;
-  ProcessObj() : proc(), netflows(), fileflows(), children(), pfo(nullptr) {
-    NFKey *emptykey = utils::getNFEmptyKey();
-    NFKey *delkey = utils::getNFDelKey();
-    OID *emptyoidkey = utils::getOIDEmptyKey();
-    OID *deloidkey = utils::getOIDDelKey();
-    netflows.set_empty_key(*emptykey);
-    netflows.set_deleted_key(*delkey);
-    fileflows.set_empty_key("-2");
-    fileflows.set_deleted_key("-1");
-    children.set_empty_key(*emptyoidkey);
-    children.set_deleted_key(*deloidkey);
-  }
-  bool operator==(const ProcessObj &p) {
-    if (pfo != nullptr && p.pfo != nullptr && pfo->exportTime != p.pfo->exportTime) {
-      return false;
+  // tracked processes sharing this host pid (pids are recycled), newest
+  // first; see ProcessContext::indexPid.
+  ProcessObj *pidPrev;
+  ProcessObj *pidNext;
+  ProcessObj()
+      : proc(), groups(nullptr), pfo(nullptr), pidPrev(nullptr),
+        pidNext(nullptr) {}
+  ~ProcessObj() { delete groups; }
+  inline FlowGroups *getGroups() {
+    if (groups == nullptr) {
+      groups = new FlowGroups();
     }
-    return (proc.oid.createTS == p.proc.oid.createTS && proc.oid.hpid == p.proc.oid.hpid);
+    return groups;
   }
+  POOLED_OBJECT(ProcessObj)
 };
 
-struct eqpfobj {
-  bool operator()(const ProcessObj *p1, const ProcessObj *p2) const {
-    return (p1->pfo->exportTime < p2->pfo->exportTime);
-  }
-};
-typedef multiset<ProcessObj *, eqpfobj> ProcessFlowSet;
+// process flows are armed through their owning process.
+typedef timer::TimerWheel<ProcessObj> ProcessFlowSet;
 typedef google::dense_hash_map<OID *, ProcessObj *, MurmurHasher<OID *>,
                                eqoidptr>
     ProcessTable;
+// newest tracked process for a host pid; older holders of a recycled pid
+// hang off it through ProcessObj::pidNext.
+typedef google::dense_hash_map<int64_t, ProcessObj *> PidTable;
 
 #endif
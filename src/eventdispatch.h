@@ -0,0 +1,143 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_EVENT_DISPATCH_
+#define __SF_EVENT_DISPATCH_
+#include "op_flags.h"
+#include "syscall_defs.h"
+#include <cstdint>
+#include <sinsp.h>
+
+#define SF_DISPATCH(HANDLER, FLAG) dispatch::Entry(dispatch::HANDLER, FLAG)
+
+namespace dispatch {
+/**
+ * Processor that consumes an event type. H_NONE marks event types that no
+ * processor handles; the main loop drops those before any thread info or
+ * container lookup.
+ **/
+enum Handler : uint8_t { H_NONE = 0, H_PROC, H_DATA, H_SETUID };
+
+struct Entry {
+  Handler handler;
+  OpFlags flag;
+  Entry() : handler(H_NONE), flag(OP_CLONE) {}
+  Entry(Handler h, OpFlags f) : handler(h), flag(f) {}
+};
+
+/**
+ * Maps every ppm event code to its handler and operation flag. The table is
+ * filled once at startup from the case lists in syscall_defs.h, so an event
+ * is dispatched with a single array load instead of a jump through the
+ * full switch.
+ *
+ * It also derives the set of event types the collector needs from the
+ * driver: the handled types plus those sinsp relies on to keep its thread
+ * and fd tables right. prune() masks everything else out in the driver so
+ * it never crosses the ring buffer.
+ **/
+class EventDispatchTable {
+private:
+  Entry m_table[PPM_EVENT_MAX];
+  bool m_required[PPM_EVENT_MAX];
+  uint32_t m_numHandled;
+  uint32_t m_numRequired;
+
+  static bool tracksState(uint16_t type) {
+    const struct ppm_event_info &info = g_event_info[type];
+    return (info.flags &
+            (EF_CREATES_FD | EF_DESTROYS_FD | EF_MODIFIES_STATE)) != 0 ||
+           (info.category & EC_INTERNAL) != 0;
+  }
+
+  static Entry classify(uint16_t type) {
+    switch (type) {
+      SF_EXECVE_ENTER()
+      SF_EXECVE_EXIT()
+      SF_CLONE_EXIT()
+      SF_PROCEXIT_E_X()
+      SF_OPEN_EXIT()
+      SF_ACCEPT_EXIT()
+      SF_CONNECT_EXIT()
+      SF_SEND_EXIT()
+      SF_RECV_EXIT()
+      SF_CLOSE_EXIT()
+      SF_SETNS_EXIT()
+      SF_MKDIR_EXIT()
+      SF_RMDIR_EXIT()
+      SF_LINK_EXIT()
+      SF_UNLINK_EXIT()
+      SF_SYMLINK_EXIT()
+      SF_RENAME_EXIT()
+      SF_SETUID_ENTER()
+      SF_SETUID_EXIT()
+      SF_SHUTDOWN_EXIT()
+      SF_MMAP_EXIT()
+    }
+    return Entry();
+  }
+
+public:
+  EventDispatchTable() : m_numHandled(0), m_numRequired(0) {
+    for (uint16_t t = 0; t < PPM_EVENT_MAX; t++) {
+      m_table[t] = classify(t);
+      if (m_table[t].handler != H_NONE) {
+        m_numHandled++;
+      }
+    }
+    // event codes come in enter (even) / exit (odd) pairs, and sinsp parses
+    // some exits against their enter event, so both halves are kept.
+    for (uint16_t t = 0; t < PPM_EVENT_MAX; t++) {
+      uint16_t pair = t ^ 1;
+      m_required[t] = m_table[t].handler != H_NONE || tracksState(t) ||
+                      (pair < PPM_EVENT_MAX &&
+                       (m_table[pair].handler != H_NONE || tracksState(pair)));
+      if (m_required[t]) {
+        m_numRequired++;
+      }
+    }
+  }
+  inline const Entry &lookup(uint16_t type) const {
+    static const Entry none;
+    return (type < PPM_EVENT_MAX) ? m_table[type] : none;
+  }
+  inline bool isRequired(uint16_t type) const {
+    return type >= PPM_EVENT_MAX || m_required[type];
+  }
+  inline uint32_t getNumHandled() const { return m_numHandled; }
+  inline uint32_t getNumRequired() const { return m_numRequired; }
+
+  /**
+   * Unsets every event type that is not required from the driver's event
+   * mask. Only live captures on the kernel module support this; sinsp throws
+   * a sinsp_exception otherwise.
+   **/
+  int prune(sinsp *inspector) const {
+    int pruned = 0;
+    for (uint32_t t = 0; t < PPM_EVENT_MAX; t++) {
+      if (!m_required[t]) {
+        inspector->unset_eventmask(t);
+        pruned++;
+      }
+    }
+    return pruned;
+  }
+};
+} // namespace dispatch
+#endif
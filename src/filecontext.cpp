@@ -22,24 +22,36 @@
 
 using file::FileContext;
 
-FileContext::FileContext(container::ContainerContext *containerCxt,
-                         writer::SysFlowWriter *writer) {
+CREATE_LOGGER(FileContext, "sysflow.file");
+FileContext::FileContext(context::SysFlowContext *cxt,
+                         container::ContainerContext *containerCxt,
+                         writer::SysFlowWriter *writer)
+    : m_nextId(1), m_bytes(0), m_hits(0), m_misses(0), m_evictions(0) {
+  m_cxt = cxt;
   m_writer = writer;
   m_containerCxt = containerCxt;
-  m_files.set_empty_key("-1");
-  m_files.set_deleted_key("-2");
+  FileKey empty = {0, nullptr, nullptr};
+  FileKey del = {1, nullptr, nullptr};
+  m_files.set_empty_key(empty);
+  m_files.set_deleted_key(del);
 }
 
 FileContext::~FileContext() { clearAllFiles(); }
 
-FileObj *FileContext::createFile(sinsp_evt *ev, string path, char typechar,
-                                 SFObjectState state, string key) {
+FileObj *FileContext::createFile(sinsp_evt *ev, const string &path,
+                                 char typechar, SFObjectState state,
+                                 const string &containerId) {
   auto *f = new FileObj();
-  f->key = std::move(key);
+  f->id = m_nextId++;
+  f->containerId = containerId;
   f->file.state = state;
   f->file.ts = ev->get_ts();
-  utils::generateFOID(f->key, &(f->file.oid));
-  f->file.path = std::move(path);
+  string key;
+  key.reserve(containerId.length() + path.length());
+  key += containerId;
+  key += path;
+  utils::generateFOID(key, &(f->file.oid));
+  f->file.path = path;
   f->file.restype = typechar;
   sinsp_threadinfo *ti = ev->get_thread_info();
   sinsp_threadinfo *mt = ti->get_main_thread();
@@ -59,66 +71,105 @@ FileObj *FileContext::getFile(sinsp_evt *ev, const string &path, char typechar,
                               SFObjectState state, bool &created) {
   sinsp_threadinfo *ti = ev->get_thread_info();
   created = true;
-  string key;
-  key.reserve(ti->m_container_id.length() + path.length());
-  key += ti->m_container_id;
-  key += path;
-  FileTable::iterator f = m_files.find(key);
+  FileTable::iterator f = m_files.find(makeFileKey(ti->m_container_id, path));
   FileObj *file = nullptr;
   if (f != m_files.end()) {
+    m_hits++;
     created = false;
-    if (f->second->written) {
+    f->second->recent = true;
+    if (f->second->epoch == m_writer->getEpoch()) {
       return f->second;
     }
     file = f->second;
     file->file.state = SFObjectState::REUP;
   }
   if (file == nullptr) {
-    file = createFile(ev, path, typechar, state, key);
+    // also the way back for evicted files, whose record is written again.
+    m_misses++;
+    file = createFile(ev, path, typechar, state, ti->m_container_id);
+    file->recent = true;
+    m_files[makeFileKey(file->containerId, file->file.path)] = file;
+    m_bytes += footprint(file);
   }
-  m_files[key] = file;
   m_writer->writeFile(&(file->file));
-  file->written = true;
+  file->epoch = m_writer->getEpoch();
   return file;
 }
 
-FileObj *FileContext::getFile(const string &key) {
-  FileTable::iterator f = m_files.find(key);
-  if (f != m_files.end()) {
-    if (!f->second->written) {
-      f->second->file.state = SFObjectState::REUP;
-      m_writer->writeFile(&(f->second->file));
-      f->second->written = true;
-    }
-    return f->second;
-  }
-  return nullptr;
+FileObj *FileContext::getFile(FileObj *file) {
+  exportFile(file);
+  return file;
 }
 
-bool FileContext::exportFile(const string &key) {
-  FileTable::iterator f = m_files.find(key);
-  bool exprt = false;
-  if (f != m_files.end()) {
-    if (!f->second->written) {
-      f->second->file.state = SFObjectState::REUP;
-      m_writer->writeFile(&(f->second->file));
-      f->second->written = true;
-      exprt = true;
-    }
+bool FileContext::exportFile(FileObj *file) {
+  if (file == nullptr || file->epoch == m_writer->getEpoch()) {
+    return false;
   }
-  return exprt;
+  file->file.state = SFObjectState::REUP;
+  m_writer->writeFile(&(file->file));
+  file->epoch = m_writer->getEpoch();
+  return true;
 }
 
-void FileContext::clearFiles() {
-  for (FileTable::iterator it = m_files.begin(); it != m_files.end(); ++it) {
-    if (it->second->refs == 0) {
-      FileObj *file = it->second;
+// Evicts up to budget files that no flow refers to and whose record was not
+// written in the current file.
+int FileContext::sweep(int budget) {
+  int removed = 0;
+  for (; budget > 0; --budget) {
+    FileTable::iterator it = m_sweep.next(m_files, m_writer->getEpoch());
+    if (it == m_files.end()) {
+      break;
+    }
+    FileObj *file = it->second;
+    if (file->refs == 0 && file->epoch != m_writer->getEpoch()) {
+      m_bytes -= footprint(file);
       m_files.erase(it);
       delete file;
-    } else {
-      it->second->written = false;
+      removed++;
     }
   }
+  return removed;
+}
+
+// Keeps the table within FILE_CACHE_MAX_BYTES using the CLOCK algorithm:
+// the hand skips files held by flows and gives files looked up since its
+// last pass a second chance. Two turns clear every reference bit, so the
+// hand stops there if only held files are left. It runs from housekeeping,
+// never while an event holds FileObj pointers.
+int FileContext::evict() {
+  size_t maxBytes = m_cxt->getFileCacheMaxBytes();
+  if (maxBytes == 0 || m_bytes <= maxBytes) {
+    return 0;
+  }
+  int evicted = 0;
+  size_t steps = 2 * m_files.size();
+  while (m_bytes > maxBytes && steps-- > 0) {
+    FileTable::iterator it = m_hand.next(m_files);
+    if (it == m_files.end()) {
+      break;
+    }
+    FileObj *file = it->second;
+    if (file->refs > 0) {
+      continue;
+    }
+    if (file->recent) {
+      file->recent = false;
+      continue;
+    }
+    m_bytes -= footprint(file);
+    m_files.erase(it);
+    delete file;
+    evicted++;
+  }
+  m_evictions += evicted;
+  return evicted;
+}
+
+void FileContext::printStats() {
+  SF_INFO(m_logger, "File cache: Entries: "
+                        << m_files.size() << " Bytes: " << m_bytes
+                        << " Hits: " << m_hits << " Misses: " << m_misses
+                        << " Evictions: " << m_evictions);
 }
 
 void FileContext::clearAllFiles() {
@@ -21,7 +21,10 @@
 #define _SF_FILE_
 #include "containercontext.h"
 #include "datatypes.h"
+#include "logger.h"
+#include "sweepcursor.h"
 #include "sysflow.h"
+#include "sysflowcontext.h"
 #include "sysflowwriter.h"
 
 using sysflow::SFObjectState;
@@ -29,24 +32,41 @@ using sysflow::SFObjectState;
 namespace file {
 class FileContext {
 private:
+  context::SysFlowContext *m_cxt;
   writer::SysFlowWriter *m_writer;
   FileTable m_files;
+  table::SweepCursor<FileTable> m_sweep;
+  table::ClockHand<FileTable> m_hand;
+  uint64_t m_nextId;
   container::ContainerContext *m_containerCxt;
+  size_t m_bytes;
+  uint64_t m_hits;
+  uint64_t m_misses;
+  uint64_t m_evictions;
+  DEFINE_LOGGER();
   void clearAllFiles();
+  // approximate heap bytes held by a file entry, including its table slot.
+  inline size_t footprint(FileObj *file) {
+    return sizeof(FileObj) + sizeof(FileTable::value_type) +
+           file->containerId.capacity() + file->file.path.capacity();
+  }
 
 public:
-  FileContext(container::ContainerContext *containerCxt,
+  FileContext(context::SysFlowContext *cxt,
+              container::ContainerContext *containerCxt,
               writer::SysFlowWriter *writer);
   virtual ~FileContext();
   FileObj *getFile(sinsp_evt *ev, sinsp_fdinfo_t *fdinfo, SFObjectState state,
                    bool &created);
   FileObj *getFile(sinsp_evt *ev, const string &path, char typechar,
                    SFObjectState state, bool &created);
-  FileObj *getFile(const string &key);
-  FileObj *createFile(sinsp_evt *ev, string path, char typechar,
-                      SFObjectState state, string key);
-  bool exportFile(const string &key);
-  void clearFiles();
+  FileObj *getFile(FileObj *file);
+  FileObj *createFile(sinsp_evt *ev, const string &path, char typechar,
+                      SFObjectState state, const string &containerId);
+  bool exportFile(FileObj *file);
+  int sweep(int budget);
+  int evict();
+  void printStats();
   inline int getSize() { return m_files.size(); }
 };
 } // namespace file
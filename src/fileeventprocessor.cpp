@@ -24,9 +24,11 @@ using fileevent::FileEventProcessor;
 
 CREATE_LOGGER(FileEventProcessor, "sysflow.fileevent");
 
-FileEventProcessor::FileEventProcessor(writer::SysFlowWriter *writer,
+FileEventProcessor::FileEventProcessor(context::SysFlowContext *cxt,
+                                       writer::SysFlowWriter *writer,
                                        process::ProcessContext *procCxt,
                                        file::FileContext *fileCxt) {
+  m_cxt = cxt;
   m_writer = writer;
   m_processCxt = procCxt;
   m_fileCxt = fileCxt;
@@ -56,34 +58,34 @@ int FileEventProcessor::writeLinkEvent(sinsp_evt *ev, OpFlags flag) {
   string path1;
   string path2;
   if (flag == OP_LINK || flag == OP_RENAME) {
-    path1 = utils::getPath(ev, "oldpath");
-    path2 = utils::getPath(ev, "newpath");
+    path1 = utils::getPath(ev, param::P_OLDPATH);
+    path2 = utils::getPath(ev, param::P_NEWPATH);
     if (IS_AT_SC(ev->get_type())) {
       int64_t olddirfd;
       int64_t newdirfd;
       if (flag == OP_RENAME) {
-        olddirfd = utils::getFD(ev, "olddirfd");
-        newdirfd = utils::getFD(ev, "newdirfd");
+        olddirfd = utils::getFD(ev, param::P_OLDDIRFD);
+        newdirfd = utils::getFD(ev, param::P_NEWDIRFD);
       } else {
-        olddirfd = utils::getFD(ev, "olddir");
-        newdirfd = utils::getFD(ev, "newdir");
+        olddirfd = utils::getFD(ev, param::P_OLDDIR);
+        newdirfd = utils::getFD(ev, param::P_NEWDIR);
       }
-      path1 = utils::getAbsolutePath(ti, olddirfd, path1);
-      path2 = utils::getAbsolutePath(ti, newdirfd, path2);
+      path1 = utils::getAbsolutePath(m_cxt, ti, olddirfd, path1);
+      path2 = utils::getAbsolutePath(m_cxt, ti, newdirfd, path2);
 
     } else {
-      path1 = utils::getAbsolutePath(ti, path1);
-      path2 = utils::getAbsolutePath(ti, path2);
+      path1 = utils::getAbsolutePath(m_cxt, ti, path1);
+      path2 = utils::getAbsolutePath(m_cxt, ti, path2);
     }
   } else if (flag == OP_SYMLINK) {
-    path1 = utils::getPath(ev, "target");
-    path2 = utils::getPath(ev, "linkpath");
+    path1 = utils::getPath(ev, param::P_TARGET);
+    path2 = utils::getPath(ev, param::P_LINKPATH);
     if (IS_AT_SC(ev->get_type())) {
-      uint64_t linkdirfd = utils::getFD(ev, "linkdirfd");
-      path2 = utils::getAbsolutePath(ti, linkdirfd, path2);
+      uint64_t linkdirfd = utils::getFD(ev, param::P_LINKDIRFD);
+      path2 = utils::getAbsolutePath(m_cxt, ti, linkdirfd, path2);
     } else {
-      path1 = utils::getAbsolutePath(ti, path1);
-      path2 = utils::getAbsolutePath(ti, path2);
+      path1 = utils::getAbsolutePath(m_cxt, ti, path1);
+      path2 = utils::getAbsolutePath(m_cxt, ti, path2);
     }
   }
   SF_DEBUG(m_logger, "Path parameters for ev: " << ev->get_name() << " are "
@@ -119,16 +121,16 @@ int FileEventProcessor::writeFileEvent(sinsp_evt *ev, OpFlags flag) {
     file = m_fileCxt->getFile(ev, fdinfo, SFObjectState::CREATED, created);
   } else {
     string fileName = (IS_UNLINKAT(ev->get_type()))
-                          ? utils::getPath(ev, "name")
-                          : utils::getPath(ev, "path");
+                          ? utils::getPath(ev, param::P_NAME)
+                          : utils::getPath(ev, param::P_PATH);
     if (IS_AT_SC(ev->get_type())) {
       sinsp_evt_param *pinfo;
       pinfo = ev->get_param(1);
       assert(pinfo->m_len == sizeof(int64_t));
       int64_t dirfd = *reinterpret_cast<int64_t *>(pinfo->m_val);
-      fileName = utils::getAbsolutePath(ti, dirfd, fileName);
+      fileName = utils::getAbsolutePath(m_cxt, ti, dirfd, fileName);
     } else {
-      fileName = utils::getAbsolutePath(ti, fileName);
+      fileName = utils::getAbsolutePath(m_cxt, ti, fileName);
     }
     FileType fileType =
         (flag == OP_MKDIR || flag == OP_RMDIR) ? SF_DIR : SF_UNK;
@@ -32,6 +32,7 @@
 namespace fileevent {
 class FileEventProcessor {
 private:
+  context::SysFlowContext *m_cxt;
   process::ProcessContext *m_processCxt;
   writer::SysFlowWriter *m_writer;
   file::FileContext *m_fileCxt;
@@ -41,7 +42,8 @@ private:
   DEFINE_LOGGER();
 
 public:
-  FileEventProcessor(writer::SysFlowWriter *writer,
+  FileEventProcessor(context::SysFlowContext *cxt,
+                     writer::SysFlowWriter *writer,
                      process::ProcessContext *procCxt,
                      file::FileContext *fileCxt);
   virtual ~FileEventProcessor();
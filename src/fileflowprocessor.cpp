@@ -19,7 +19,6 @@
 
 #include "fileflowprocessor.h"
 #include "utils.h"
-#include <boost/stacktrace.hpp>
 #include <utility>
 
 using fileflow::FileFlowProcessor;
@@ -42,7 +41,8 @@ FileFlowProcessor::~FileFlowProcessor() = default;
 
 inline void FileFlowProcessor::populateFileFlow(FileFlowObj *ff, OpFlags flag,
                                                 sinsp_evt *ev, ProcessObj *proc,
-                                                FileObj *file, string flowkey,
+                                                FileObj *file,
+                                                const FFKey &flowkey,
                                                 sinsp_fdinfo_t *fdinfo,
                                                 int64_t fd) {
   sinsp_threadinfo *ti = ev->get_thread_info();
@@ -58,8 +58,9 @@ inline void FileFlowProcessor::populateFileFlow(FileFlowObj *ff, OpFlags flag,
   ff->fileflow.tid = ti->m_tid;
   ff->fileflow.fd = fd;
   ff->fileflow.fileOID = file->file.oid;
-  ff->filekey = file->key;
-  ff->flowkey = std::move(flowkey);
+  ff->file = file;
+  ff->flowkey = flowkey;
+  ff->selectPath = is_select_path(fdinfo->m_name);
   ff->fileflow.numRRecvOps = 0;
   ff->fileflow.numWSendOps = 0;
   ff->fileflow.numRRecvBytes = 0;
@@ -69,27 +70,39 @@ inline void FileFlowProcessor::populateFileFlow(FileFlowObj *ff, OpFlags flag,
 void FileFlowProcessor::removeAndWriteRelatedFlows(ProcessObj *proc,
                                                    FileFlowObj *ffo,
                                                    uint64_t endTs) {
+  if (proc->groups == nullptr) {
+    return;
+  }
+  FileFlowGroups::iterator gi = proc->groups->ff.find(siblingKey(ffo->flowkey));
+  if (gi == proc->groups->ff.end()) {
+    return;
+  }
   vector<FileFlowObj *> ffobjs;
-  for (FileFlowTable::iterator ffi = proc->fileflows.begin();
-       ffi != proc->fileflows.end(); ffi++) {
-    if (ffi->second->fileflow.tid != ffo->fileflow.tid &&
-        ffi->second->fileflow.fd == ffo->fileflow.fd &&
-        ffi->second->filekey.compare(ffo->filekey) == 0) {
-      if (ffi->second->fileflow.opFlags & OP_OPEN) {
-        ffobjs.insert(ffobjs.begin(), ffi->second);
+  DataFlowObj *head = gi->second;
+  DataFlowObj *dfo = head;
+  do {
+    auto *ff = static_cast<FileFlowObj *>(dfo);
+    if (ff->flowkey.tid != ffo->flowkey.tid) {
+      if (ff->fileflow.opFlags & OP_OPEN) {
+        ffobjs.insert(ffobjs.begin(), ff);
       } else {
-        ffobjs.push_back(ffi->second);
+        ffobjs.push_back(ff);
       }
-      SF_DEBUG(m_logger, "Removing related file flow on thread: "
-                             << ffi->second->fileflow.tid);
-      proc->fileflows.erase(ffi);
     }
+    dfo = dfo->sibNext;
+  } while (dfo != head);
+  for (auto it = ffobjs.begin(); it != ffobjs.end(); it++) {
+    SF_DEBUG(m_logger,
+             "Removing related file flow on thread: " << (*it)->flowkey.tid);
+    proc->fileflows.erase((*it)->flowkey);
+    unlinkSibling(&(proc->getGroups()->ff), (*it)->flowkey, *it);
   }
   for (auto it = ffobjs.begin(); it != ffobjs.end(); it++) {
     (*it)->fileflow.endTs = endTs;
     (*it)->fileflow.opFlags |= OP_TRUNCATE;
     // m_writer->writeFileFlow(&((*it)->fileflow));
     SHOULD_WRITE((*it))
+    (*it)->file->refs--;
     removeFileFlowFromSet(&(*it), true);
   }
 }
@@ -118,7 +131,7 @@ inline void FileFlowProcessor::updateFileFlow(FileFlowObj *ff, OpFlags flag,
 
 inline void FileFlowProcessor::processNewFlow(sinsp_evt *ev, ProcessObj *proc,
                                               FileObj *file, OpFlags flag,
-                                              const string &flowkey,
+                                              const FFKey &flowkey,
                                               sinsp_fdinfo_t *fdinfo,
                                               int64_t fd) {
   auto *ff = new FileFlowObj();
@@ -128,8 +141,9 @@ inline void FileFlowProcessor::processNewFlow(sinsp_evt *ev, ProcessObj *proc,
   updateFileFlow(ff, flag, ev, fdinfo);
   if (flag != OP_CLOSE) {
     proc->fileflows[ff->flowkey] = ff;
+    linkSibling(&(proc->getGroups()->ff), ff->flowkey, ff);
     file->refs++;
-    m_dfSet->insert(ff);
+    m_dfSet->schedule(ff, ff->exportTime + m_cxt->getNFExportInterval());
   } else {
     removeAndWriteRelatedFlows(proc, ff, ev->get_ts());
     ff->fileflow.endTs = ev->get_ts();
@@ -141,22 +155,23 @@ inline void FileFlowProcessor::processNewFlow(sinsp_evt *ev, ProcessObj *proc,
 
 inline void FileFlowProcessor::removeAndWriteFileFlow(ProcessObj *proc,
                                                       FileObj *file,
-                                                      FileFlowObj **ff,
-                                                      string flowkey) {
+                                                      FileFlowObj **ff) {
   // m_writer->writeFileFlow(&((*ff)->fileflow));
   SHOULD_WRITE((*ff))
   removeFileFlowFromSet(ff, false);
-  removeFileFlow(proc, file, ff, std::move(flowkey));
+  removeFileFlow(proc, file, ff);
 }
 
-inline void FileFlowProcessor::processExistingFlow(
-    sinsp_evt *ev, ProcessObj *proc, FileObj *file, OpFlags flag,
-    string flowkey, FileFlowObj *ff, sinsp_fdinfo_t *fdinfo) {
+inline void FileFlowProcessor::processExistingFlow(sinsp_evt *ev,
+                                                   ProcessObj *proc,
+                                                   FileObj *file, OpFlags flag,
+                                                   FileFlowObj *ff,
+                                                   sinsp_fdinfo_t *fdinfo) {
   updateFileFlow(ff, flag, ev, fdinfo);
   if (flag == OP_CLOSE) {
     removeAndWriteRelatedFlows(proc, ff, ev->get_ts());
     ff->fileflow.endTs = ev->get_ts();
-    removeAndWriteFileFlow(proc, file, &ff, std::move(flowkey));
+    removeAndWriteFileFlow(proc, file, &ff);
   }
 }
 
@@ -216,14 +231,11 @@ int FileFlowProcessor::handleFileFlowEvent(sinsp_evt *ev, OpFlags flag) {
   ProcessObj *proc = m_processCxt->getProcess(ev, SFObjectState::REUP, created);
   FileFlowObj *ff = nullptr;
   sinsp_threadinfo *ti = ev->get_thread_info();
-  string flowkey;
-  flowkey.reserve(ti->m_container_id.length() + fdinfo->m_name.length() + 32);
-  flowkey += fdinfo->m_name;
-  flowkey += ti->m_container_id;
-  flowkey.append(utils::itoa(ti->m_tid, 10));
-  flowkey.append(utils::itoa(fd, 10));
-
   FileObj *file = m_fileCxt->getFile(ev, fdinfo, SFObjectState::REUP, created);
+  FFKey flowkey;
+  flowkey.fileid = file->id;
+  flowkey.tid = ti->m_tid;
+  flowkey.fd = fd;
   FileFlowTable::iterator ffi = proc->fileflows.find(flowkey);
   if (ffi != proc->fileflows.end()) {
     ff = ffi->second;
@@ -236,15 +248,15 @@ int FileFlowProcessor::handleFileFlowEvent(sinsp_evt *ev, OpFlags flag) {
   if (ff == nullptr) {
     processNewFlow(ev, proc, file, flag, flowkey, fdinfo, fd);
   } else {
-    processExistingFlow(ev, proc, file, flag, flowkey, ff, fdinfo);
+    processExistingFlow(ev, proc, file, flag, ff, fdinfo);
   }
   return 0;
 }
 
 void FileFlowProcessor::removeFileFlow(ProcessObj *proc, FileObj *file,
-                                       FileFlowObj **ff,
-                                       const string &flowkey) {
-  proc->fileflows.erase(flowkey);
+                                       FileFlowObj **ff) {
+  proc->fileflows.erase((*ff)->flowkey);
+  unlinkSibling(&(proc->getGroups()->ff), (*ff)->flowkey, *ff);
   delete *ff;
   ff = nullptr;
   if (file != nullptr) {
@@ -258,7 +270,7 @@ int FileFlowProcessor::removeAndWriteFFFromProc(ProcessObj *proc, int64_t tid) {
   for (FileFlowTable::iterator ffi = proc->fileflows.begin();
        ffi != proc->fileflows.end(); ffi++) {
     if (tid == -1 || tid == ffi->second->fileflow.tid) {
-      FileObj *file = m_fileCxt->getFile(ffi->second->filekey);
+      FileObj *file = m_fileCxt->getFile(ffi->second->file);
       ffi->second->fileflow.endTs = utils::getSysdigTime(m_cxt);
       if (tid != -1) {
         removeAndWriteRelatedFlows(proc, ffi->second,
@@ -269,14 +281,15 @@ int FileFlowProcessor::removeAndWriteFFFromProc(ProcessObj *proc, int64_t tid) {
       SHOULD_WRITE(ffi->second)
       // m_writer->writeFileFlow(&(ffi->second->fileflow));
       FileFlowObj *ffo = ffi->second;
+      uint64_t fileid = ffo->flowkey.fileid;
       proc->fileflows.erase(ffi);
+      unlinkSibling(&(proc->getGroups()->ff), ffo->flowkey, ffo);
       SF_DEBUG(m_logger, "Set size: " << m_dfSet->size());
       deleted += removeFileFlowFromSet(&ffo, true);
       SF_DEBUG(m_logger, "After Set size: " << m_dfSet->size());
       if (file == nullptr) {
         SF_ERROR(m_logger, "File object doesn't exist for fileflow: "
-                               << ffi->second->filekey
-                               << ". This shouldn't happen.");
+                               << fileid << ". This shouldn't happen.");
       } else {
         file->refs--;
       }
@@ -284,63 +297,20 @@ int FileFlowProcessor::removeAndWriteFFFromProc(ProcessObj *proc, int64_t tid) {
   }
   if (tid == -1) {
     proc->fileflows.clear();
+    if (proc->groups != nullptr) {
+      proc->groups->ff.clear();
+    }
   }
   return deleted;
 }
 
 int FileFlowProcessor::removeFileFlowFromSet(FileFlowObj **ffo,
                                              bool deleteFileFlow) {
-  bool found = false;
-  int removed = 0;
-  for (auto iter = m_dfSet->find(*ffo); iter != m_dfSet->end(); iter++) {
-    if (!((*iter)->isNetworkFlow)) {
-      auto *foundObj = static_cast<FileFlowObj *>(*iter);
-      if (*foundObj == **ffo) {
-        SF_DEBUG(m_logger, "Removing fileflow element from multiset");
-        m_dfSet->erase(iter);
-        if (deleteFileFlow) {
-          delete *ffo;
-          ffo = nullptr;
-        }
-        removed++;
-        found = true;
-        break;
-      }
-    }
-  }
-  if (!found) {
-    SF_ERROR(m_logger,
-             "Cannot find FileFlow Object "
-                 << (*ffo)->filekey << " " << (*ffo)->flowkey << " "
-                 << (*ffo)->fileflow.opFlags << " " << (*ffo)->fileflow.endTs
-                 << " " << boost::stacktrace::stacktrace()
-                 << " in data flow set. Deleting. This should not happen.");
-    ProcessObj *proc = m_processCxt->getProcess(&((*ffo)->fileflow.procOID));
-    if (proc == nullptr) {
-      SF_ERROR(m_logger, "Could not find proc "
-                             << (*ffo)->fileflow.procOID.hpid << " "
-                             << (*ffo)->fileflow.procOID.createTS
-                             << " This shouldn't happen!");
-    } else {
-      FileObj *file = m_fileCxt->getFile((*ffo)->filekey);
-      if (file == nullptr) {
-        SF_ERROR(m_logger, "Unable to find file object of key "
-                               << (*ffo)->filekey << ". Shouldn't happen!");
-      } else {
-        SF_ERROR(m_logger,
-                 "Proc name: " << proc->proc.exe << " " << proc->proc.exeArgs
-                               << " Pid: " << proc->proc.oid.hpid << " "
-                               << " File Name: " << file->file.path << " "
-                               << " File type: " << file->file.restype);
-      }
-    }
-
-    if (deleteFileFlow) {
-      SF_ERROR(m_logger, "Deleting File Flow...");
-      delete *ffo;
-      ffo = nullptr;
-      SF_ERROR(m_logger, "Deleted File Flow...");
-    }
+  // flows popped by the timer wheel are already unlinked.
+  int removed = m_dfSet->cancel(*ffo) ? 1 : 0;
+  if (deleteFileFlow) {
+    delete *ffo;
+    *ffo = nullptr;
   }
   return removed;
 }
@@ -358,12 +328,12 @@ void FileFlowProcessor::removeFileFlow(DataFlowObj *dfo) {
                                               << ffo->fileflow.procOID.createTS
                                               << " This shouldn't happen!");
   } else {
-    FileObj *file = m_fileCxt->getFile(ffo->filekey);
+    FileObj *file = m_fileCxt->getFile(ffo->file);
     if (file == nullptr) {
       SF_ERROR(m_logger, "Unable to find file object of key "
-                             << ffo->filekey << ". Shouldn't happen!");
+                             << ffo->flowkey.fileid << ". Shouldn't happen!");
     }
-    removeFileFlow(proc, file, &ffo, ffo->flowkey);
+    removeFileFlow(proc, file, &ffo);
   }
 }
 
@@ -371,7 +341,7 @@ void FileFlowProcessor::exportFileFlow(DataFlowObj *dfo, time_t /*now*/) {
   auto *ffo = static_cast<FileFlowObj *>(dfo);
   ffo->fileflow.endTs = utils::getSysdigTime(m_cxt);
   m_processCxt->exportProcess(&(ffo->fileflow.procOID));
-  m_fileCxt->exportFile(ffo->filekey);
+  m_fileCxt->exportFile(ffo->file);
   SHOULD_WRITE(ffo)
   // m_writer->writeFileFlow(&(ffo->fileflow));
   SF_DEBUG(m_logger, "Reupping flow");
@@ -0,0 +1,144 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_FLOW_KEY_
+#define __SF_FLOW_KEY_
+#include <arpa/inet.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// IPv6 address as two 64-bit words in network byte order. IPv4 addresses are
+// stored v4-mapped (::ffff:a.b.c.d), so both families share one key type.
+struct NFAddr {
+  uint64_t hi;
+  uint64_t lo;
+};
+
+inline bool operator==(const NFAddr &a1, const NFAddr &a2) {
+  return a1.lo == a2.lo && a1.hi == a2.hi;
+}
+
+inline NFAddr nfaddr(const uint32_t *b) {
+  NFAddr a;
+  std::memcpy(&a, b, sizeof(a));
+  return a;
+}
+
+inline NFAddr nfaddr4(uint32_t ip) {
+  uint32_t b[4] = {0, 0, htonl(0xffff), ip};
+  return nfaddr(b);
+}
+
+inline bool isV4Addr(const NFAddr &a) {
+  uint32_t b[4];
+  std::memcpy(b, &a, sizeof(b));
+  return a.hi == 0 && b[2] == htonl(0xffff);
+}
+
+// IPv4 address (network byte order) of a v4-mapped address.
+inline uint32_t nfaddrV4(const NFAddr &a) {
+  uint32_t b[4];
+  std::memcpy(b, &a, sizeof(b));
+  return b[3];
+}
+
+inline std::string nfaddrToString(const NFAddr &a) {
+  char buf[INET6_ADDRSTRLEN];
+  if (isV4Addr(a)) {
+    uint32_t ip = nfaddrV4(a);
+    inet_ntop(AF_INET, &ip, buf, sizeof(buf));
+  } else {
+    inet_ntop(AF_INET6, &a, buf, sizeof(buf));
+  }
+  return std::string(buf);
+}
+
+// network flow key; fields are ordered so the struct has no padding and can be
+// hashed and compared as 64-bit words.
+struct NFKey {
+  uint64_t tid;
+  NFAddr ip1;
+  NFAddr ip2;
+  uint16_t port1;
+  uint16_t port2;
+  uint32_t fd;
+};
+static_assert(sizeof(NFKey) == 48, "NFKey must not contain padding");
+
+// 64-bit finalizer from MurmurHash3; spreads every input bit over the low
+// bits used by power-of-two tables.
+inline uint64_t mix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+struct NFKeyHasher {
+  size_t operator()(const NFKey &k) const {
+    uint64_t rest = (static_cast<uint64_t>(k.port1) << 48) |
+                    (static_cast<uint64_t>(k.port2) << 32) | k.fd;
+    uint64_t seed = k.tid * 0x9e3779b97f4a7c15ULL;
+    // IPv4 flows hash the same two 32-bit addresses as before.
+    if (isV4Addr(k.ip1) && isV4Addr(k.ip2)) {
+      uint64_t ips = (static_cast<uint64_t>(nfaddrV4(k.ip1)) << 32) |
+                     nfaddrV4(k.ip2);
+      return mix64(mix64(ips ^ seed) ^ rest);
+    }
+    uint64_t h = mix64(k.ip1.hi ^ seed);
+    h = mix64(h ^ k.ip1.lo);
+    h = mix64(h ^ k.ip2.hi);
+    h = mix64(h ^ k.ip2.lo);
+    return mix64(h ^ rest);
+  }
+};
+
+struct eqnfkey {
+  bool operator()(const NFKey &n1, const NFKey &n2) const {
+    return (n1.ip1 == n2.ip1 && n1.ip2 == n2.ip2 && n1.port1 == n2.port1 &&
+            n1.port2 == n2.port2 && n1.tid == n2.tid && n1.fd == n2.fd);
+  }
+};
+
+// file flows are keyed on the interned file id rather than its path.
+struct FFKey {
+  uint64_t fileid;
+  int64_t tid;
+  int64_t fd;
+};
+static_assert(sizeof(FFKey) == 24, "FFKey must not contain padding");
+
+struct FFKeyHasher {
+  size_t operator()(const FFKey &k) const {
+    return mix64(mix64(k.fileid ^ (static_cast<uint64_t>(k.tid) *
+                                   0x9e3779b97f4a7c15ULL)) ^
+                 static_cast<uint64_t>(k.fd));
+  }
+};
+
+struct eqffkey {
+  bool operator()(const FFKey &f1, const FFKey &f2) const {
+    return (f1.fileid == f2.fileid && f1.tid == f2.tid && f1.fd == f2.fd);
+  }
+};
+#endif
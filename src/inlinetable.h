@@ -0,0 +1,284 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_INLINE_TABLE_
+#define __SF_INLINE_TABLE_
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#define INLINE_TABLE_SIZE 4
+
+namespace table {
+/**
+ * Map that keeps its first few entries in place and only allocates a hash
+ * table, initialized through Init::init(Map *), once it outgrows them. Most
+ * processes never hold more than a handful of flows, so they pay neither the
+ * bucket allocation nor the empty/deleted key setup of a dense_hash_map.
+ * Like dense_hash_map, erasing through an iterator keeps it valid for
+ * incrementing.
+ **/
+template <typename Map, typename Init, size_t N = INLINE_TABLE_SIZE>
+class InlineMap {
+public:
+  typedef typename Map::key_type key_type;
+  typedef typename Map::mapped_type mapped_type;
+  typedef typename Map::value_type value_type;
+  typedef typename Map::key_equal key_equal;
+
+  class iterator {
+    friend class InlineMap;
+
+  private:
+    InlineMap *m_tbl;
+    size_t m_pos;
+    typename Map::iterator m_it;
+    iterator(InlineMap *tbl, size_t pos) : m_tbl(tbl), m_pos(pos), m_it() {
+      skip();
+    }
+    iterator(InlineMap *tbl, typename Map::iterator it)
+        : m_tbl(tbl), m_pos(N), m_it(it) {}
+    inline void skip() {
+      while (m_pos < N && !m_tbl->isLive(m_pos)) {
+        m_pos++;
+      }
+    }
+
+  public:
+    iterator() : m_tbl(nullptr), m_pos(N), m_it() {}
+    inline value_type &operator*() const {
+      return m_tbl->m_map != nullptr ? *m_it : *m_tbl->slot(m_pos);
+    }
+    inline value_type *operator->() const { return &(operator*()); }
+    inline iterator &operator++() {
+      if (m_tbl->m_map != nullptr) {
+        ++m_it;
+      } else {
+        m_pos++;
+        skip();
+      }
+      return *this;
+    }
+    inline iterator operator++(int) {
+      iterator tmp(*this);
+      ++(*this);
+      return tmp;
+    }
+    inline bool operator==(const iterator &it) const {
+      return m_tbl->m_map != nullptr ? m_it == it.m_it : m_pos == it.m_pos;
+    }
+    inline bool operator!=(const iterator &it) const { return !(*this == it); }
+  };
+
+private:
+  typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type
+      m_slots[N];
+  uint32_t m_live;
+  uint32_t m_size;
+  Map *m_map;
+  static_assert(N <= 32, "inline map capacity exceeds live mask");
+
+  inline bool isLive(size_t i) const { return (m_live & (1U << i)) != 0; }
+  inline value_type *slot(size_t i) {
+    return reinterpret_cast<value_type *>(&m_slots[i]);
+  }
+  inline void destroy(size_t i) {
+    slot(i)->~value_type();
+    m_live &= ~(1U << i);
+    m_size--;
+  }
+  void promote() {
+    m_map = new Map();
+    Init::init(m_map);
+    for (size_t i = 0; i < N; i++) {
+      if (isLive(i)) {
+        m_map->insert(*slot(i));
+        slot(i)->~value_type();
+      }
+    }
+    m_live = 0;
+  }
+
+public:
+  InlineMap() : m_live(0), m_size(0), m_map(nullptr) {}
+  InlineMap(const InlineMap &) = delete;
+  InlineMap &operator=(const InlineMap &) = delete;
+  ~InlineMap() { clear(); }
+
+  inline iterator begin() {
+    return m_map != nullptr ? iterator(this, m_map->begin()) : iterator(this, 0);
+  }
+  inline iterator end() {
+    return m_map != nullptr ? iterator(this, m_map->end()) : iterator(this, N);
+  }
+  inline size_t size() const {
+    return m_map != nullptr ? m_map->size() : m_size;
+  }
+  inline bool empty() const { return size() == 0; }
+
+  iterator find(const key_type &key) {
+    if (m_map != nullptr) {
+      return iterator(this, m_map->find(key));
+    }
+    key_equal eq;
+    for (size_t i = 0; i < N; i++) {
+      if (isLive(i) && eq(slot(i)->first, key)) {
+        return iterator(this, i);
+      }
+    }
+    return end();
+  }
+
+  std::pair<iterator, bool> insert(const value_type &val) {
+    if (m_map != nullptr) {
+      std::pair<typename Map::iterator, bool> res = m_map->insert(val);
+      return std::make_pair(iterator(this, res.first), res.second);
+    }
+    iterator it = find(val.first);
+    if (it != end()) {
+      return std::make_pair(it, false);
+    }
+    if (m_size < N) {
+      for (size_t i = 0; i < N; i++) {
+        if (!isLive(i)) {
+          new (slot(i)) value_type(val);
+          m_live |= (1U << i);
+          m_size++;
+          return std::make_pair(iterator(this, i), true);
+        }
+      }
+    }
+    promote();
+    std::pair<typename Map::iterator, bool> res = m_map->insert(val);
+    return std::make_pair(iterator(this, res.first), res.second);
+  }
+
+  inline mapped_type &operator[](const key_type &key) {
+    return insert(value_type(key, mapped_type())).first->second;
+  }
+
+  size_t erase(const key_type &key) {
+    iterator it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+  inline void erase(iterator it) {
+    if (m_map != nullptr) {
+      m_map->erase(it.m_it);
+    } else {
+      destroy(it.m_pos);
+    }
+  }
+
+  void clear() {
+    for (size_t i = 0; i < N; i++) {
+      if (isLive(i)) {
+        destroy(i);
+      }
+    }
+    delete m_map;
+    m_map = nullptr;
+    m_size = 0;
+  }
+};
+
+/**
+ * Set counterpart of InlineMap.
+ **/
+template <typename Set, typename Init, size_t N = INLINE_TABLE_SIZE>
+class InlineSet {
+public:
+  typedef typename Set::key_type key_type;
+  typedef typename Set::key_equal key_equal;
+
+private:
+  key_type m_keys[N];
+  uint32_t m_size;
+  Set *m_set;
+
+public:
+  InlineSet() : m_size(0), m_set(nullptr) {}
+  InlineSet(const InlineSet &) = delete;
+  InlineSet &operator=(const InlineSet &) = delete;
+  ~InlineSet() { delete m_set; }
+
+  inline size_t size() const {
+    return m_set != nullptr ? m_set->size() : m_size;
+  }
+  inline bool empty() const { return size() == 0; }
+
+  size_t count(const key_type &key) const {
+    if (m_set != nullptr) {
+      return m_set->count(key);
+    }
+    key_equal eq;
+    for (size_t i = 0; i < m_size; i++) {
+      if (eq(m_keys[i], key)) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  bool insert(const key_type &key) {
+    if (m_set != nullptr) {
+      return m_set->insert(key).second;
+    }
+    if (count(key) != 0) {
+      return false;
+    }
+    if (m_size < N) {
+      m_keys[m_size++] = key;
+      return true;
+    }
+    m_set = new Set();
+    Init::init(m_set);
+    m_set->insert(m_keys, m_keys + m_size);
+    m_size = 0;
+    return m_set->insert(key).second;
+  }
+
+  size_t erase(const key_type &key) {
+    if (m_set != nullptr) {
+      return m_set->erase(key);
+    }
+    key_equal eq;
+    for (size_t i = 0; i < m_size; i++) {
+      if (eq(m_keys[i], key)) {
+        m_keys[i] = m_keys[--m_size];
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  void clear() {
+    delete m_set;
+    m_set = nullptr;
+    m_size = 0;
+  }
+};
+} // namespace table
+#endif
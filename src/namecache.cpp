@@ -0,0 +1,76 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "namecache.h"
+
+using namecache::NameCache;
+
+CREATE_LOGGER(NameCache, "sysflow.namecache");
+
+NameCache::NameCache(sinsp *inspector, int ttl)
+    : m_inspector(inspector), m_ttl(ttl), m_hits(0), m_misses(0),
+      m_negative(0) {}
+
+NameCache::~NameCache() = default;
+
+const std::string &NameCache::lookup(NameTable *table, uint32_t id,
+                                     time_t now, bool user) {
+  NameTable::iterator it = table->find(id);
+  if (it != table->end() && now < it->second.expires) {
+    m_hits++;
+    return it->second.name;
+  }
+  m_misses++;
+  if (it == table->end()) {
+    if (table->size() >= NAME_CACHE_MAX_ENTRIES) {
+      SF_DEBUG(m_logger, "Name cache full, clearing "
+                             << (user ? "user" : "group") << " table");
+      table->clear();
+    }
+    it = table->emplace(id, Entry()).first;
+  }
+  Entry &e = it->second;
+  e.found = false;
+  if (user) {
+    scap_userinfo *info = m_inspector->get_user(id);
+    if (info != nullptr) {
+      e.name = info->name;
+      e.found = true;
+    }
+  } else if (id != 0xffffffff) {
+    auto git = m_inspector->m_grouplist.find(id);
+    if (git != m_inspector->m_grouplist.end()) {
+      e.name = git->second->name;
+      e.found = true;
+    }
+  }
+  if (!e.found) {
+    e.name.clear();
+    m_negative++;
+  }
+  e.expires = now + (e.found ? m_ttl : NAME_CACHE_NEG_TTL);
+  return e.name;
+}
+
+void NameCache::printStats() {
+  SF_INFO(m_logger, "Name cache: Users: "
+                        << m_users.size() << " Groups: " << m_groups.size()
+                        << " Hits: " << m_hits << " Misses: " << m_misses
+                        << " Negative: " << m_negative);
+}
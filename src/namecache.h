@@ -0,0 +1,76 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_NAME_CACHE_
+#define __SF_NAME_CACHE_
+#include "logger.h"
+#include <cstdint>
+#include <ctime>
+#include <sinsp.h>
+#include <string>
+#include <unordered_map>
+
+#define NAME_CACHE_TTL "NAME_CACHE_TTL"
+#define DEFAULT_NAME_CACHE_TTL 300
+#define NAME_CACHE_NEG_TTL 30
+#define NAME_CACHE_MAX_ENTRIES 65536
+
+namespace namecache {
+/**
+ * Caches the user and group names sinsp knows for each uid and gid. Names
+ * are stored once per id and returned by reference. Ids sinsp doesn't know
+ * (common for users that only exist inside a container) are cached as
+ * negative entries resolving to the empty string.
+ *
+ * Entries are looked up again in sinsp once they are older than the ttl,
+ * or NAME_CACHE_NEG_TTL seconds for negative entries, so users added after
+ * startup are picked up.
+ **/
+class NameCache {
+private:
+  struct Entry {
+    std::string name;
+    time_t expires;
+    bool found;
+  };
+  typedef std::unordered_map<uint32_t, Entry> NameTable;
+  sinsp *m_inspector;
+  NameTable m_users;
+  NameTable m_groups;
+  int m_ttl;
+  uint64_t m_hits;
+  uint64_t m_misses;
+  uint64_t m_negative;
+  DEFINE_LOGGER();
+  const std::string &lookup(NameTable *table, uint32_t id, time_t now,
+                            bool user);
+
+public:
+  NameCache(sinsp *inspector, int ttl);
+  virtual ~NameCache();
+  inline const std::string &getUserName(uint32_t uid, time_t now) {
+    return lookup(&m_users, uid, now, true);
+  }
+  inline const std::string &getGroupName(uint32_t gid, time_t now) {
+    return lookup(&m_groups, gid, now, false);
+  }
+  void printStats();
+};
+} // namespace namecache
+#endif
@@ -26,7 +26,8 @@ CREATE_LOGGER(NetworkFlowProcessor, "sysflow.networkflow");
 NetworkFlowProcessor::NetworkFlowProcessor(context::SysFlowContext *cxt,
                                            writer::SysFlowWriter *writer,
                                            process::ProcessContext *processCxt,
-                                           DataFlowSet *dfSet) {
+                                           DataFlowSet *dfSet)
+    : m_numV6Flows(0) {
   m_cxt = cxt;
   m_writer = writer;
   m_processCxt = processCxt;
@@ -59,34 +60,27 @@ inline int32_t NetworkFlowProcessor::getProtocol(scap_l4_proto proto) {
 inline void NetworkFlowProcessor::canonicalizeKey(sinsp_fdinfo_t *fdinfo,
                                                   NFKey *key, uint64_t tid,
                                                   uint64_t fd) {
-  uint32_t sip = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_sip;
-  uint32_t dip = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dip;
-  uint32_t sport = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_sport;
-  uint32_t dport = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dport;
   key->tid = tid;
   key->fd = fd;
-  key->ip1 = sip;
-  key->port1 = sport;
-  key->ip2 = dip;
-  key->port2 = dport;
-}
-
-inline void NetworkFlowProcessor::canonicalizeKey(NetFlowObj *nf, NFKey *key) {
-  uint32_t sip = nf->netflow.sip;
-  uint32_t dip = nf->netflow.dip;
-  uint32_t sport = nf->netflow.sport;
-  uint32_t dport = nf->netflow.dport;
-  key->tid = nf->netflow.tid;
-  key->fd = nf->netflow.fd;
-  key->ip1 = sip;
-  key->port1 = sport;
-  key->ip2 = dip;
-  key->port2 = dport;
+  if (fdinfo->is_ipv6_socket()) {
+    ipv6tuple *t = &(fdinfo->m_sockinfo.m_ipv6info);
+    key->ip1 = nfaddr(t->m_fields.m_sip.m_b);
+    key->port1 = t->m_fields.m_sport;
+    key->ip2 = nfaddr(t->m_fields.m_dip.m_b);
+    key->port2 = t->m_fields.m_dport;
+  } else {
+    ipv4tuple *t = &(fdinfo->m_sockinfo.m_ipv4info);
+    key->ip1 = nfaddr4(t->m_fields.m_sip);
+    key->port1 = t->m_fields.m_sport;
+    key->ip2 = nfaddr4(t->m_fields.m_dip);
+    key->port2 = t->m_fields.m_dport;
+  }
 }
 
 inline void NetworkFlowProcessor::populateNetFlow(NetFlowObj *nf, OpFlags flag,
                                                   sinsp_evt *ev,
-                                                  ProcessObj *proc) {
+                                                  ProcessObj *proc,
+                                                  const NFKey &key) {
   sinsp_fdinfo_t *fdinfo = ev->get_fd_info();
   sinsp_threadinfo *ti = ev->get_thread_info();
   nf->netflow.opFlags = flag;
@@ -96,10 +90,12 @@ inline void NetworkFlowProcessor::populateNetFlow(NetFlowObj *nf, OpFlags flag,
   nf->netflow.procOID.hpid = proc->proc.oid.hpid;
   nf->netflow.procOID.createTS = proc->proc.oid.createTS;
   nf->netflow.tid = ti->m_tid;
-  nf->netflow.sip = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_sip;
-  nf->netflow.dip = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dip;
-  nf->netflow.sport = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_sport;
-  nf->netflow.dport = fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dport;
+  nf->key = key;
+  // v4-mapped IPv6 flows are recorded as IPv4.
+  nf->netflow.sip = nf->hasV4Tuple() ? nfaddrV4(key.ip1) : 0;
+  nf->netflow.dip = nf->hasV4Tuple() ? nfaddrV4(key.ip2) : 0;
+  nf->netflow.sport = key.port1;
+  nf->netflow.dport = key.port2;
   nf->netflow.proto = getProtocol(fdinfo->get_l4proto());
   nf->netflow.numRRecvOps = 0;
   nf->netflow.numWSendOps = 0;
@@ -107,6 +103,14 @@ inline void NetworkFlowProcessor::populateNetFlow(NetFlowObj *nf, OpFlags flag,
   nf->netflow.numWSendBytes = 0;
 }
 
+inline void NetworkFlowProcessor::writeNetFlow(NetFlowObj *nf) {
+  if (nf->hasV4Tuple()) {
+    m_writer->writeNetFlow(&(nf->netflow));
+  } else {
+    m_numV6Flows++;
+  }
+}
+
 inline void NetworkFlowProcessor::updateNetFlow(NetFlowObj *nf, OpFlags flag,
                                                 sinsp_evt *ev) {
   nf->netflow.opFlags |= flag;
@@ -132,15 +136,16 @@ inline void NetworkFlowProcessor::processNewFlow(sinsp_evt *ev,
   auto *nf = new NetFlowObj();
   nf->exportTime = utils::getCurrentTime(m_cxt);
   nf->lastUpdate = utils::getCurrentTime(m_cxt);
-  populateNetFlow(nf, flag, ev, proc);
+  populateNetFlow(nf, flag, ev, proc, key);
   updateNetFlow(nf, flag, ev);
   if (flag != OP_CLOSE) {
     proc->netflows[key] = nf;
-    m_dfSet->insert(nf);
+    linkSibling(&(proc->getGroups()->nf), key, nf);
+    m_dfSet->schedule(nf, nf->exportTime + m_cxt->getNFExportInterval());
   } else {
     removeAndWriteRelatedFlows(proc, &key, ev->get_ts());
     nf->netflow.endTs = ev->get_ts();
-    m_writer->writeNetFlow(&(nf->netflow));
+    writeNetFlow(nf);
     delete nf;
   }
 }
@@ -148,7 +153,7 @@ inline void NetworkFlowProcessor::processNewFlow(sinsp_evt *ev,
 inline void NetworkFlowProcessor::removeAndWriteNetworkFlow(ProcessObj *proc,
                                                             NetFlowObj **nf,
                                                             NFKey *key) {
-  m_writer->writeNetFlow(&((*nf)->netflow));
+  writeNetFlow(*nf);
   removeNetworkFlowFromSet(nf, false);
   removeNetworkFlow(proc, nf, key);
 }
@@ -180,13 +185,6 @@ int NetworkFlowProcessor::handleNetFlowEvent(sinsp_evt *ev, OpFlags flag) {
                            << fdinfo->get_typechar() << ". Ignoring...");
     return 1;
   }
-
-  if (fdinfo->is_ipv6_socket()) {
-    SF_DEBUG(
-        m_logger,
-        "IPv6 is not supported in the current version of SysFlow. Ignoring...");
-    return 1;
-  }
   bool created = false;
   // calling get process is important because it ensures that the process object
   // has been written to the sysflow file. This is important for long running
@@ -195,15 +193,13 @@ int NetworkFlowProcessor::handleNetFlowEvent(sinsp_evt *ev, OpFlags flag) {
   NetFlowObj *nf = nullptr;
 
   sinsp_threadinfo *ti = ev->get_thread_info();
-  static NFKey key = NFKey();
+  NFKey key;
   canonicalizeKey(fdinfo, &key, ti->m_tid, ev->get_fd_num());
-  SF_DEBUG(m_logger, "Key: " << key.ip1 << " " << key.ip2 << " " << key.port1
-                             << " " << key.port2 << " " << key.tid << " "
-                             << key.fd);
   SF_DEBUG(m_logger,
            "Size of network flow table in process " << proc->netflows.size());
   NetworkFlowTable::iterator nfi = proc->netflows.find(key);
-  SF_DEBUG(m_logger, "Key: " << key.ip1 << " " << key.ip2 << " " << key.port1
+  SF_DEBUG(m_logger, "Key: " << nfaddrToString(key.ip1) << " "
+                             << nfaddrToString(key.ip2) << " " << key.port1
                              << " " << key.port2 << " " << key.tid << " "
                              << key.fd);
   if (nfi != proc->netflows.end()) {
@@ -211,10 +207,12 @@ int NetworkFlowProcessor::handleNetFlowEvent(sinsp_evt *ev, OpFlags flag) {
   }
 
   if (IS_DEBUG_ENABLED(m_logger)) {
-    string ip4tuple =
-        ipv4tuple_to_string(&(fdinfo->m_sockinfo.m_ipv4info), false);
+    string iptuple =
+        fdinfo->is_ipv6_socket()
+            ? ipv6tuple_to_string(&(fdinfo->m_sockinfo.m_ipv6info), false)
+            : ipv4tuple_to_string(&(fdinfo->m_sockinfo.m_ipv4info), false);
     SF_DEBUG(m_logger, proc->proc.exe
-                           << " " << ip4tuple
+                           << " " << iptuple
                            << " Proto: " << getProtocol(fdinfo->get_l4proto())
                            << " Server: " << fdinfo->is_role_server()
                            << " Client: " << fdinfo->is_role_client() << " "
@@ -235,6 +233,7 @@ int NetworkFlowProcessor::handleNetFlowEvent(sinsp_evt *ev, OpFlags flag) {
 void NetworkFlowProcessor::removeNetworkFlow(ProcessObj *proc, NetFlowObj **nf,
                                              NFKey *key) {
   proc->netflows.erase(*key);
+  unlinkSibling(&(proc->getGroups()->nf), *key, *nf);
   delete *nf;
   nf = nullptr;
 }
@@ -242,27 +241,37 @@ void NetworkFlowProcessor::removeNetworkFlow(ProcessObj *proc, NetFlowObj **nf,
 void NetworkFlowProcessor::removeAndWriteRelatedFlows(ProcessObj *proc,
                                                       NFKey *key,
                                                       uint64_t endTs) {
+  if (proc->groups == nullptr) {
+    return;
+  }
+  NetworkFlowGroups::iterator gi = proc->groups->nf.find(siblingKey(*key));
+  if (gi == proc->groups->nf.end()) {
+    return;
+  }
   vector<NetFlowObj *> nfobjs;
-  for (NetworkFlowTable::iterator nfi = proc->netflows.begin();
-       nfi != proc->netflows.end(); nfi++) {
-    if (nfi->first.tid != key->tid && nfi->first.ip1 == key->ip1 &&
-        nfi->first.port1 == key->port1 && nfi->first.ip2 == key->ip2 &&
-        nfi->first.port2 == key->port2 && nfi->first.fd == key->fd) {
-      if (nfi->second->netflow.opFlags & OP_ACCEPT ||
-          nfi->second->netflow.opFlags & OP_CONNECT) {
-        nfobjs.insert(nfobjs.begin(), nfi->second);
+  DataFlowObj *head = gi->second;
+  DataFlowObj *dfo = head;
+  do {
+    auto *nf = static_cast<NetFlowObj *>(dfo);
+    if (nf->key.tid != key->tid) {
+      if (nf->netflow.opFlags & OP_ACCEPT || nf->netflow.opFlags & OP_CONNECT) {
+        nfobjs.insert(nfobjs.begin(), nf);
       } else {
-        nfobjs.push_back(nfi->second);
+        nfobjs.push_back(nf);
       }
-      SF_DEBUG(m_logger,
-               "Removing related network flow on thread: " << nfi->first.tid);
-      proc->netflows.erase(nfi);
     }
+    dfo = dfo->sibNext;
+  } while (dfo != head);
+  for (auto it = nfobjs.begin(); it != nfobjs.end(); it++) {
+    SF_DEBUG(m_logger,
+             "Removing related network flow on thread: " << (*it)->key.tid);
+    proc->netflows.erase((*it)->key);
+    unlinkSibling(&(proc->getGroups()->nf), (*it)->key, *it);
   }
   for (auto it = nfobjs.begin(); it != nfobjs.end(); it++) {
     (*it)->netflow.endTs = endTs;
     (*it)->netflow.opFlags |= OP_TRUNCATE;
-    m_writer->writeNetFlow(&((*it)->netflow));
+    writeNetFlow(*it);
     removeNetworkFlowFromSet(&(*it), true);
   }
 }
@@ -276,15 +285,15 @@ int NetworkFlowProcessor::removeAndWriteNFFromProc(ProcessObj *proc,
     if (tid == -1 || tid == nfi->second->netflow.tid) {
       nfi->second->netflow.endTs = utils::getSysdigTime(m_cxt);
       if (tid != -1) {
-        static NFKey k;
-        canonicalizeKey(nfi->second, &k);
-        removeAndWriteRelatedFlows(proc, &k, nfi->second->netflow.endTs);
+        removeAndWriteRelatedFlows(proc, &(nfi->second->key),
+                                   nfi->second->netflow.endTs);
       }
       nfi->second->netflow.opFlags |= OP_TRUNCATE;
       SF_DEBUG(m_logger, "Writing NETFLOW!");
-      m_writer->writeNetFlow(&(nfi->second->netflow));
+      writeNetFlow(nfi->second);
       NetFlowObj *nfo = nfi->second;
       proc->netflows.erase(nfi);
+      unlinkSibling(&(proc->getGroups()->nf), nfo->key, nfo);
       SF_DEBUG(m_logger, "Set size: " << m_dfSet->size());
       deleted += removeNetworkFlowFromSet(&nfo, true);
       SF_DEBUG(m_logger, "After Set size: " << m_dfSet->size());
@@ -292,48 +301,30 @@ int NetworkFlowProcessor::removeAndWriteNFFromProc(ProcessObj *proc,
   }
   if (tid == -1) {
     proc->netflows.clear();
+    if (proc->groups != nullptr) {
+      proc->groups->nf.clear();
+    }
   }
   return deleted;
 }
 
 int NetworkFlowProcessor::removeNetworkFlowFromSet(NetFlowObj **nfo,
                                                    bool deleteNetFlow) {
-  bool found = false;
-  int removed = 0;
-  for (auto iter = m_dfSet->find(*nfo); iter != m_dfSet->end(); iter++) {
-    if ((*iter)->isNetworkFlow) {
-      auto *foundObj = static_cast<NetFlowObj *>(*iter);
-      if (*foundObj == **nfo) {
-        SF_DEBUG(m_logger, "Removing netflow element from multiset.");
-        m_dfSet->erase(iter);
-        if (deleteNetFlow) {
-          delete *nfo;
-          nfo = nullptr;
-        }
-        removed++;
-        found = true;
-        break;
-      }
-    }
-  }
-  if (!found) {
-    SF_ERROR(m_logger, "Cannot find Netflow Object in data flow set. Deleting. "
-                       "This should not happen");
-    if (deleteNetFlow) {
-      delete *nfo;
-      nfo = nullptr;
-    }
+  // flows popped by the timer wheel are already unlinked.
+  int removed = m_dfSet->cancel(*nfo) ? 1 : 0;
+  if (deleteNetFlow) {
+    delete *nfo;
+    *nfo = nullptr;
   }
   return removed;
 }
 
 void NetworkFlowProcessor::removeNetworkFlow(DataFlowObj *dfo) {
-  NFKey key{};
   auto *nfo = static_cast<NetFlowObj *>(dfo);
+  NFKey key = nfo->key;
   // do we want to write out a netflow that hasn't had any action in an
   // interval? nfo->netflow.endTs = utils::getSysdigTime(m_cxt);
   // m_writer->writeNetFlow(&(nfo->netflow));
-  canonicalizeKey(nfo, &key);
   SF_DEBUG(m_logger, "Erasing network flow");
   ProcessObj *proc = m_processCxt->getProcess(&(nfo->netflow.procOID));
   if (proc == nullptr) {
@@ -350,7 +341,7 @@ void NetworkFlowProcessor::exportNetworkFlow(DataFlowObj *dfo, time_t /*now*/) {
   auto *nfo = static_cast<NetFlowObj *>(dfo);
   nfo->netflow.endTs = utils::getSysdigTime(m_cxt);
   m_processCxt->exportProcess(&(nfo->netflow.procOID));
-  m_writer->writeNetFlow(&(nfo->netflow));
+  writeNetFlow(nfo);
   SF_DEBUG(m_logger, "Reupping network flow");
   nfo->netflow.ts = utils::getSysdigTime(m_cxt);
   nfo->netflow.endTs = 0;
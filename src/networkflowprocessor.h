@@ -36,12 +36,13 @@ private:
   process::ProcessContext *m_processCxt;
   writer::SysFlowWriter *m_writer;
   DataFlowSet *m_dfSet;
+  uint64_t m_numV6Flows;
   DEFINE_LOGGER();
   void canonicalizeKey(sinsp_fdinfo_t *fdinfo, NFKey *key, uint64_t tid,
                        uint64_t fd);
-  void canonicalizeKey(NetFlowObj *nf, NFKey *key);
   void populateNetFlow(NetFlowObj *nf, OpFlags flag, sinsp_evt *ev,
-                       ProcessObj *proc);
+                       ProcessObj *proc, const NFKey &key);
+  void writeNetFlow(NetFlowObj *nf);
   void updateNetFlow(NetFlowObj *nf, OpFlags flag, sinsp_evt *ev);
   void processExistingFlow(sinsp_evt *ev, ProcessObj *proc, OpFlags flag,
                            NFKey key, NetFlowObj *nf);
@@ -59,6 +60,8 @@ public:
   virtual ~NetworkFlowProcessor();
   int handleNetFlowEvent(sinsp_evt *ev, OpFlags flag);
   inline int getSize() { return m_processCxt->getNumNetworkFlows(); }
+  // IPv6 flow records not written because the schema has IPv4 addresses only.
+  inline uint64_t getNumV6Flows() { return m_numV6Flows; }
   int removeAndWriteNFFromProc(ProcessObj *proc, int64_t tid);
   void removeNetworkFlow(DataFlowObj *dfo);
   void exportNetworkFlow(DataFlowObj *dfo, time_t now);
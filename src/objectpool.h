@@ -0,0 +1,137 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_OBJECT_POOL_
+#define __SF_OBJECT_POOL_
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#define POOL_SLAB_BYTES 65536
+
+namespace pool {
+/**
+ * Allocation counters shared by all object pools so they can be reported
+ * together.
+ **/
+class PoolStats {
+public:
+  const char *name;
+  size_t objSize;
+  uint64_t slabs{0};
+  uint64_t capacity{0};
+  uint64_t inUse{0};
+  uint64_t peak{0};
+  uint64_t allocs{0};
+  uint64_t frees{0};
+  explicit PoolStats(const char *n, size_t sz) : name(n), objSize(sz) {}
+  inline uint64_t getSlabBytes() const { return slabs * POOL_SLAB_BYTES; }
+};
+
+inline std::vector<PoolStats *> &getPools() {
+  static std::vector<PoolStats *> s_pools;
+  return s_pools;
+}
+
+/**
+ * Type-specific slab allocator. Objects are carved out of fixed size slabs and
+ * recycled through an intrusive freelist, so the churn of short lived flows and
+ * processes does not fragment the malloc heap. Slabs are kept for the lifetime
+ * of the collector and reused. Pools are only used from the event loop thread.
+ **/
+template <typename T> class ObjectPool {
+private:
+  union Slot {
+    Slot *next;
+    alignas(T) unsigned char obj[sizeof(T)];
+  };
+  static_assert(sizeof(Slot) <= POOL_SLAB_BYTES,
+                "object too large for pool slab");
+  Slot *m_free;
+  std::vector<Slot *> m_slabs;
+  PoolStats m_stats;
+
+  void grow() {
+    size_t n = POOL_SLAB_BYTES / sizeof(Slot);
+    Slot *slab = static_cast<Slot *>(::operator new(n * sizeof(Slot)));
+    m_slabs.push_back(slab);
+    for (size_t i = 0; i < n; i++) {
+      slab[i].next = m_free;
+      m_free = &slab[i];
+    }
+    m_stats.slabs++;
+    m_stats.capacity += n;
+  }
+
+  explicit ObjectPool(const char *name)
+      : m_free(nullptr), m_stats(name, sizeof(T)) {
+    getPools().push_back(&m_stats);
+  }
+
+public:
+  ObjectPool(const ObjectPool &) = delete;
+  ObjectPool &operator=(const ObjectPool &) = delete;
+  // never destroyed, so objects released during shutdown stay valid.
+  static ObjectPool &instance(const char *name) {
+    static ObjectPool *s_pool = new ObjectPool(name);
+    return *s_pool;
+  }
+  inline void *allocate(size_t size) {
+    // derived types have their own layout and go to the heap.
+    if (size != sizeof(T)) {
+      return ::operator new(size);
+    }
+    if (m_free == nullptr) {
+      grow();
+    }
+    Slot *s = m_free;
+    m_free = s->next;
+    m_stats.allocs++;
+    if (++m_stats.inUse > m_stats.peak) {
+      m_stats.peak = m_stats.inUse;
+    }
+    return s;
+  }
+  inline void deallocate(void *p, size_t size) {
+    if (p == nullptr) {
+      return;
+    }
+    if (size != sizeof(T)) {
+      ::operator delete(p);
+      return;
+    }
+    Slot *s = static_cast<Slot *>(p);
+    s->next = m_free;
+    m_free = s;
+    m_stats.frees++;
+    m_stats.inUse--;
+  }
+};
+} // namespace pool
+
+// routes new/delete of a class through its object pool.
+#define POOLED_OBJECT(ClassName)                                               \
+  static void *operator new(size_t size) {                                     \
+    return pool::ObjectPool<ClassName>::instance(#ClassName).allocate(size);   \
+  }                                                                            \
+  static void operator delete(void *p, size_t size) {                          \
+    pool::ObjectPool<ClassName>::instance(#ClassName).deallocate(p, size);     \
+  }
+#endif
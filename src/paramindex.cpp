@@ -0,0 +1,48 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "paramindex.h"
+#include <cstring>
+
+using param::ParamIndex;
+
+static const char *const s_paramNames[param::P_NUM_NAMES] = {
+    "fd",      "flags",    "path",     "name",   "oldpath",
+    "newpath", "olddirfd", "newdirfd", "olddir", "newdir",
+    "target",  "linkpath", "linkdirfd"};
+
+ParamIndex::ParamIndex() {
+  memset(m_index, -1, sizeof(m_index));
+  for (uint32_t t = 0; t < PPM_EVENT_MAX; t++) {
+    const struct ppm_event_info &info = g_event_info[t];
+    for (uint32_t i = 0; i < info.nparams && i < PPM_MAX_EVENT_PARAMS; i++) {
+      for (int n = 0; n < P_NUM_NAMES; n++) {
+        if (m_index[t][n] < 0 &&
+            strcmp(info.params[i].name, s_paramNames[n]) == 0) {
+          m_index[t][n] = static_cast<int8_t>(i);
+        }
+      }
+    }
+  }
+}
+
+const ParamIndex &ParamIndex::instance() {
+  static const ParamIndex s_index;
+  return s_index;
+}
@@ -0,0 +1,81 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_PARAM_INDEX_
+#define __SF_PARAM_INDEX_
+#include <cstdint>
+#include <sinsp.h>
+
+namespace param {
+/**
+ * Event parameters looked up by name by the collector. Each maps to the
+ * name used in the driver's event tables (see paramindex.cpp).
+ **/
+enum ParamName : uint8_t {
+  P_FD = 0,
+  P_FLAGS,
+  P_PATH,
+  P_NAME,
+  P_OLDPATH,
+  P_NEWPATH,
+  P_OLDDIRFD,
+  P_NEWDIRFD,
+  P_OLDDIR,
+  P_NEWDIR,
+  P_TARGET,
+  P_LINKPATH,
+  P_LINKDIRFD,
+  P_NUM_NAMES
+};
+
+/**
+ * Maps (event type, parameter name) to the parameter's position in the
+ * event. The table is built once from g_event_info, so a lookup is an array
+ * load instead of a loop building a string for every parameter name.
+ **/
+class ParamIndex {
+private:
+  int8_t m_index[PPM_EVENT_MAX][P_NUM_NAMES];
+  ParamIndex();
+
+public:
+  static const ParamIndex &instance();
+  /**
+   * Returns the position of parameter name in events of the given type,
+   * or -1 if that event type has no such parameter.
+   **/
+  inline int find(uint16_t type, ParamName name) const {
+    return (type < PPM_EVENT_MAX) ? m_index[type][name] : -1;
+  }
+  /**
+   * Returns the parameter of ev called name together with its info, or
+   * nullptr if ev does not carry it.
+   **/
+  inline const sinsp_evt_param *get(sinsp_evt *ev, ParamName name,
+                                    const ppm_param_info **info) const {
+    int i = find(ev->get_type(), name);
+    if (i < 0 || static_cast<uint32_t>(i) >= ev->get_num_params()) {
+      return nullptr;
+    }
+    *info = ev->get_param_info(i);
+    return ev->get_param(i);
+  }
+};
+} // namespace param
+#endif
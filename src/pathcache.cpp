@@ -0,0 +1,153 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "pathcache.h"
+#include "MurmurHash3.h"
+#include "ghc/fs_std.hpp"
+
+using pathcache::PathCache;
+
+CREATE_LOGGER(PathCache, "sysflow.pathcache");
+
+static const std::string s_noBase;
+
+PathCache::PathCache(size_t capacity, bool resolveLinks, int linkBudget)
+    : m_capacity(capacity), m_resolveLinks(resolveLinks),
+      m_linkBudget(linkBudget), m_linksLeft(linkBudget),
+      m_budgetStart(std::chrono::steady_clock::now()), m_hits(0),
+      m_misses(0), m_evictions(0), m_resolved(0) {
+  m_entries.reserve(m_capacity);
+}
+
+PathCache::~PathCache() = default;
+
+PathCache::Key PathCache::makeKey(const std::string &base,
+                                  const std::string &path) {
+  Key key;
+  uint32_t seed = 0;
+  MurmurHash3_x86_32(base.c_str(), base.size(), 0, &seed);
+  key.hash = 0;
+  MurmurHash3_x86_32(path.c_str(), path.size(), seed, &key.hash);
+  key.base = &base;
+  key.path = &path;
+  return key;
+}
+
+std::string PathCache::lexicallyNormal(const std::string &base,
+                                       const std::string &path) {
+  std::string out;
+  out.reserve(base.size() + path.size() + 1);
+  const std::string *parts[2] = {&base, &path};
+  int first = (!path.empty() && path[0] == '/') ? 1 : 0;
+  for (int i = first; i < 2; i++) {
+    const std::string &s = *parts[i];
+    size_t pos = 0;
+    while (pos < s.size()) {
+      size_t end = s.find('/', pos);
+      if (end == std::string::npos) {
+        end = s.size();
+      }
+      size_t len = end - pos;
+      if (len == 0 || (len == 1 && s[pos] == '.')) {
+        // empty or "." segment
+      } else if (len == 2 && s[pos] == '.' && s[pos + 1] == '.') {
+        size_t slash = out.rfind('/');
+        out.resize(slash == std::string::npos ? 0 : slash);
+      } else {
+        out.push_back('/');
+        out.append(s, pos, len);
+      }
+      pos = end + 1;
+    }
+  }
+  if (out.empty()) {
+    out.push_back('/');
+  }
+  return out;
+}
+
+bool PathCache::takeLinkBudget() {
+  auto now = std::chrono::steady_clock::now();
+  if (now - m_budgetStart >= std::chrono::seconds(1)) {
+    m_budgetStart = now;
+    m_linksLeft = m_linkBudget;
+  }
+  if (m_linksLeft <= 0) {
+    return false;
+  }
+  m_linksLeft--;
+  return true;
+}
+
+std::string PathCache::resolve(const std::string &base,
+                               const std::string &path) {
+  std::string lexical = lexicallyNormal(base, path);
+  try {
+    m_resolved++;
+    return fs::weakly_canonical(fs::path(lexical)).string();
+  } catch (...) {
+    SF_WARN(m_logger, "Unable to compute canonical path from " << lexical);
+  }
+  return lexical;
+}
+
+std::string PathCache::canonicalize(const std::string &base,
+                                    const std::string &path) {
+  const std::string &b = (!path.empty() && path[0] == '/') ? s_noBase : base;
+  EntryMap::iterator it = m_entries.find(makeKey(b, path));
+  if (it != m_entries.end()) {
+    m_hits++;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->canonical;
+  }
+  m_misses++;
+  std::string canonical;
+  if (m_resolveLinks) {
+    if (!takeLinkBudget()) {
+      return lexicallyNormal(b, path);
+    }
+    canonical = resolve(b, path);
+  } else {
+    canonical = lexicallyNormal(b, path);
+  }
+  if (m_capacity == 0) {
+    return canonical;
+  }
+  if (m_entries.size() >= m_capacity) {
+    Entry &last = m_lru.back();
+    m_entries.erase(makeKey(last.base, last.path));
+    m_lru.pop_back();
+    m_evictions++;
+  }
+  m_lru.push_front(Entry());
+  Entry &e = m_lru.front();
+  e.base = b;
+  e.path = path;
+  e.canonical = canonical;
+  m_entries[makeKey(e.base, e.path)] = m_lru.begin();
+  return canonical;
+}
+
+void PathCache::printStats() {
+  SF_INFO(m_logger, "Path cache: Entries: "
+                        << m_entries.size() << " Hits: " << m_hits
+                        << " Misses: " << m_misses
+                        << " Evictions: " << m_evictions
+                        << " Symlink Resolutions: " << m_resolved);
+}
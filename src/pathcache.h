@@ -0,0 +1,102 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_PATH_CACHE_
+#define __SF_PATH_CACHE_
+#include "logger.h"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#define PATH_CACHE_SIZE "PATH_CACHE_SIZE"
+#define DEFAULT_PATH_CACHE_SIZE 4096
+#define RESOLVE_SYMLINKS "RESOLVE_SYMLINKS"
+#define DEFAULT_SYMLINK_BUDGET 64
+
+namespace pathcache {
+/**
+ * Canonicalizes paths seen in events without touching the filesystem.
+ * Relative paths are joined to the cwd or dirfd path they were resolved
+ * against, and ".", ".." and repeated separators are removed lexically.
+ * Results are kept in an LRU cache keyed on (base, path).
+ *
+ * When symlink resolution is enabled, paths are instead resolved with
+ * fs::weakly_canonical on the collector's host filesystem, at most
+ * m_linkBudget times per second; past that budget the lexical result is
+ * returned and not cached, so the path is resolved again later.
+ **/
+class PathCache {
+private:
+  struct Entry {
+    std::string base;
+    std::string path;
+    std::string canonical;
+  };
+  struct Key {
+    size_t hash;
+    const std::string *base;
+    const std::string *path;
+  };
+  struct KeyHasher {
+    size_t operator()(const Key &k) const { return k.hash; }
+  };
+  struct KeyEq {
+    bool operator()(const Key &k1, const Key &k2) const {
+      return k1.hash == k2.hash && *k1.path == *k2.path &&
+             *k1.base == *k2.base;
+    }
+  };
+  typedef std::list<Entry> EntryList;
+  typedef std::unordered_map<Key, EntryList::iterator, KeyHasher, KeyEq>
+      EntryMap;
+
+  EntryList m_lru;
+  EntryMap m_entries;
+  size_t m_capacity;
+  bool m_resolveLinks;
+  int m_linkBudget;
+  int m_linksLeft;
+  std::chrono::steady_clock::time_point m_budgetStart;
+  uint64_t m_hits;
+  uint64_t m_misses;
+  uint64_t m_evictions;
+  uint64_t m_resolved;
+  DEFINE_LOGGER();
+
+  static Key makeKey(const std::string &base, const std::string &path);
+  bool takeLinkBudget();
+  std::string resolve(const std::string &base, const std::string &path);
+
+public:
+  PathCache(size_t capacity, bool resolveLinks, int linkBudget);
+  virtual ~PathCache();
+  static std::string lexicallyNormal(const std::string &base,
+                                     const std::string &path);
+  /**
+   * Returns the canonical form of path. Relative paths are taken relative
+   * to base, which must be absolute; base is ignored for absolute paths.
+   **/
+  std::string canonicalize(const std::string &base, const std::string &path);
+  inline size_t size() { return m_entries.size(); }
+  void printStats();
+};
+} // namespace pathcache
+#endif
@@ -26,13 +26,15 @@ ProcessContext::ProcessContext(context::SysFlowContext *cxt,
                                container::ContainerContext *ccxt,
                                file::FileContext *fileCxt,
                                writer::SysFlowWriter *writer)
-    : m_procs(PROC_TABLE_SIZE), m_delProcQue() {
+    : m_procs(PROC_TABLE_SIZE), m_pids(PROC_TABLE_SIZE), m_delProcQue() {
   m_cxt = cxt;
   OID *emptyoidkey = utils::getOIDEmptyKey();
   OID *deloidkey = utils::getOIDDelKey();
   m_delProcTime = utils::getCurrentTime(m_cxt);
   m_procs.set_empty_key(emptyoidkey);
   m_procs.set_deleted_key(deloidkey);
+  m_pids.set_empty_key(PID_EMPTY_KEY);
+  m_pids.set_deleted_key(PID_DEL_KEY);
   m_containerCxt = ccxt;
   m_writer = writer;
   m_fileCxt = fileCxt;
@@ -92,24 +94,14 @@ ProcessObj *ProcessContext::createProcess(sinsp_threadinfo *ti,
     }
   }
   p->proc.exe = (mainthread->m_exepath.empty())
-                    ? utils::getAbsolutePath(mainthread, mainthread->m_exe)
+                    ? utils::getAbsolutePath(m_cxt, mainthread, mainthread->m_exe)
                     : mainthread->m_exepath;
   SF_DEBUG(m_logger, "createProcess: The exepath is "
                          << p->proc.exe
                          << " mt->exepath: " << mainthread->get_exepath()
                          << " EXE: " << mainthread->get_exe()
                          << " CWD: " << mainthread->get_cwd());
-  p->proc.exeArgs.clear();
-  int i = 0;
-  for (auto it = mainthread->m_args.begin(); it != mainthread->m_args.end();
-       ++it) {
-    if (i == 0) {
-      p->proc.exeArgs += *it;
-    } else {
-      p->proc.exeArgs += " " + *it;
-    }
-    i++;
-  }
+  setExeArgs(&(p->proc), mainthread);
   p->proc.uid = mainthread->m_uid;
   p->proc.gid = mainthread->m_gid;
   p->proc.userName = utils::getUserName(m_cxt, mainthread->m_uid);
@@ -187,19 +179,79 @@ void ProcessContext::reupContainer(sinsp_threadinfo *ti, ProcessObj *proc) {
 }
 
 ProcessObj *ProcessContext::getProcess(int64_t pid) {
-  // SF_DEBUG(m_logger, "getProcess PID: " << pid)
-  ProcessTable::iterator it;
-  // SF_DEBUG(m_logger, " Size of Proc Table: " << m_procs.size())
-  for (it = m_procs.begin(); it != m_procs.end(); it++) {
-    // SF_DEBUG(m_logger, "getProcess Iterating PID: " << it->first->hpid)
-    if (it->first->hpid == pid) {
-      // SF_DEBUG(m_logger, "getProcess FOUND/RETURNING PID: " << pid)
-      return it->second;
+  PidTable::iterator it = m_pids.find(pid);
+  if (it != m_pids.end()) {
+    return it->second;
+  }
+  return nullptr;
+}
+
+// Links proc into the list of tracked processes with its pid, kept newest
+// first by createTS. A new process is almost always the newest, so this
+// stops at the head.
+void ProcessContext::indexPid(ProcessObj *proc) {
+  std::pair<PidTable::iterator, bool> res =
+      m_pids.insert(std::make_pair(proc->proc.oid.hpid, proc));
+  if (res.second) {
+    proc->pidPrev = nullptr;
+    proc->pidNext = nullptr;
+    return;
+  }
+  ProcessObj *prev = nullptr;
+  ProcessObj *next = res.first->second;
+  while (next != nullptr &&
+         next->proc.oid.createTS > proc->proc.oid.createTS) {
+    prev = next;
+    next = next->pidNext;
+  }
+  proc->pidPrev = prev;
+  proc->pidNext = next;
+  if (next != nullptr) {
+    next->pidPrev = proc;
+  }
+  if (prev != nullptr) {
+    prev->pidNext = proc;
+  } else {
+    res.first->second = proc;
+  }
+}
+
+void ProcessContext::unindexPid(ProcessObj *proc) {
+  if (proc->pidNext != nullptr) {
+    proc->pidNext->pidPrev = proc->pidPrev;
+  }
+  if (proc->pidPrev != nullptr) {
+    proc->pidPrev->pidNext = proc->pidNext;
+  } else {
+    PidTable::iterator it = m_pids.find(proc->proc.oid.hpid);
+    if (it != m_pids.end() && it->second == proc) {
+      if (proc->pidNext != nullptr) {
+        it->second = proc->pidNext;
+      } else {
+        m_pids.erase(it);
+      }
     }
   }
+  proc->pidPrev = nullptr;
+  proc->pidNext = nullptr;
+}
 
-  // SF_DEBUG(m_logger, "getProcess RETURN NULL")
-  return nullptr;
+void ProcessContext::addProcess(ProcessObj *proc) {
+  std::pair<ProcessTable::iterator, bool> res =
+      m_procs.insert(std::make_pair(&(proc->proc.oid), proc));
+  if (res.second) {
+    indexPid(proc);
+  } else if (res.first->second != proc) {
+    unindexPid(res.first->second);
+    res.first->second = proc;
+    indexPid(proc);
+  }
+}
+
+void ProcessContext::removeProcess(ProcessObj *proc) {
+  if (m_procs.erase(&(proc->proc.oid)) > 0) {
+    unindexPid(proc);
+  }
 }
 
 ProcessObj *ProcessContext::getProcess(sinsp_evt *ev, SFObjectState state,
@@ -241,13 +293,18 @@ ProcessObj *ProcessContext::getProcess(sinsp_evt *ev, SFObjectState state,
 	    std::cout << "Parent is now nil!!!" << proc->second->proc.poid.get_OID().hpid << " " << proc->second->proc.poid.get_OID().createTS << std::endl;
     }*/
 
-    if (proc->second->written) {
+    if (proc->second->chainEpoch == m_writer->getEpoch()) {
+      return proc->second;
+    }
+    if (isWritten(proc->second)) {
+      writeProcessAndAncestors(proc->second);
       return proc->second;
     }
     process = proc->second;
     process->proc.state = SFObjectState::REUP;
   }
-  std::vector<ProcessObj *> processes;
+  std::vector<ProcessObj *> &processes = m_newProcs;
+  processes.clear();
   if (process == nullptr) {
     //use the curretn thread here rather than the main thread because it appears the main
     //thread does not always get the container id right away.
@@ -282,7 +339,7 @@ ProcessObj *ProcessContext::getProcess(sinsp_evt *ev, SFObjectState state,
       SF_DEBUG(m_logger, "FOUND PARENT PID: " << mt->m_pid << " ts " << mt->m_clone_ts
                                       << " EXEPATH: " << mt->m_exepath
                                       << " EXE: " << mt->m_exe)
-      if (proc2->second->written) {
+      if (isWritten(proc2->second)) {
         break;
       } else {
         parent = proc2->second;
@@ -314,7 +371,7 @@ ProcessObj *ProcessContext::getProcess(sinsp_evt *ev, SFObjectState state,
                                                    << " create TS "
                                                    << prt->proc.oid.createTS
                                                    << " exe: " << prt->proc.exe)
-      if (!prt->written) {
+      if (!isWritten(prt)) {
         SF_DEBUG(m_logger, "Writing to process vector...")
         processes.push_back(prt);
       }
@@ -333,10 +390,12 @@ ProcessObj *ProcessContext::getProcess(sinsp_evt *ev, SFObjectState state,
   for (auto it = processes.rbegin(); it != processes.rend(); ++it) {
     SF_DEBUG(m_logger, "Writing process " << (*it)->proc.exe << " "
                                           << (*it)->proc.oid.hpid);
-    m_procs[&((*it)->proc.oid)] = (*it);
+    addProcess(*it);
     m_writer->writeProcess(&((*it)->proc));
-    (*it)->written = true;
+    (*it)->writtenEpoch = m_writer->getEpoch();
   }
+  // fills in ancestors above the first written parent and memoizes the chain.
+  writeProcessAndAncestors(process);
   SF_DEBUG(m_logger, " Size of Proc Table: " << m_procs.size())
   return process;
 }
@@ -360,14 +419,45 @@ bool ProcessContext::exportProcess(OID *oid) {
   if (!p->proc.containerId.is_null()) {
     m_containerCxt->exportContainer(p->proc.containerId.get_string());
   }
-  if (!p->written) {
-    m_writer->writeProcess(&(p->proc));
-    p->written = true;
+  if (!isWritten(p)) {
     expt = true;
   }
+  writeProcessAndAncestors(p);
   return expt;
 }
 
+// Joins the arguments of mainthread into proc->exeArgs in place, in a single
+// buffer capped at the EXE_ARGS_MAX_BYTES budget. REUP records of a process
+// still in the table reuse the string already on the record.
+void ProcessContext::setExeArgs(Process *proc, sinsp_threadinfo *mainthread) {
+  const std::vector<std::string> &argv = mainthread->m_args;
+  size_t len = 0;
+  for (auto it = argv.begin(); it != argv.end(); ++it) {
+    len += it->size() + 1;
+  }
+  string &args = proc->exeArgs;
+  size_t budget = m_cxt->getExeArgsMaxBytes();
+  args.clear();
+  args.reserve((budget > 0 && len > budget) ? budget : len);
+  for (auto it = argv.begin(); it != argv.end(); ++it) {
+    if (it != argv.begin()) {
+      args.push_back(' ');
+    }
+    args.append(*it);
+    if (budget > 0 && args.size() > budget) {
+      size_t marker = sizeof(EXE_ARGS_TRUNCATED) - 1;
+      size_t cut = (budget > marker) ? budget - marker : 0;
+      // don't split a UTF-8 sequence.
+      while (cut > 0 && (args[cut] & 0xC0) == 0x80) {
+        cut--;
+      }
+      args.resize(cut);
+      args.append(EXE_ARGS_TRUNCATED, (budget > marker) ? marker : budget);
+      break;
+    }
+  }
+}
+
 void ProcessContext::updateProcess(Process *proc, sinsp_evt *ev,
                                    SFObjectState state) {
   sinsp_threadinfo *ti = ev->get_thread_info();
@@ -375,71 +465,46 @@ void ProcessContext::updateProcess(Process *proc, sinsp_evt *ev,
   proc->state = state;
   proc->ts = ev->get_ts();
   proc->exe = (mainthread->m_exepath.empty())
-                  ? utils::getAbsolutePath(mainthread, mainthread->m_exe)
+                  ? utils::getAbsolutePath(m_cxt, mainthread, mainthread->m_exe)
                   : mainthread->m_exepath;
-  proc->exeArgs.clear();
-  int i = 0;
-  for (auto it = mainthread->m_args.begin(); it != mainthread->m_args.end();
-       ++it) {
-    if (i == 0) {
-      proc->exeArgs += *it;
-    } else {
-      proc->exeArgs += " " + *it;
-    }
-    i++;
-  }
+  setExeArgs(proc, mainthread);
   proc->uid = mainthread->m_uid;
   proc->gid = mainthread->m_gid;
   proc->userName = utils::getUserName(m_cxt, mainthread->m_uid);
   proc->groupName = utils::getGroupName(m_cxt, mainthread->m_gid);
 }
 
-void ProcessContext::clearProcesses() {
-  for (ProcessTable::iterator it = m_procs.begin(); it != m_procs.end(); ++it) {
-    if (it->second->netflows.empty() && it->second->fileflows.empty() &&
-        it->second->children.empty() && it->second->pfo == nullptr) {
-      ProcessObj *proc = it->second;
-      Process::poid_t poid = proc->proc.poid;
-      ProcessObj *curProc = proc;
-
-      while (!poid.is_null()) {
-        OID key = poid.get_OID();
+// Evicts processes without flows or children whose record was not written in
+// the current file, looking at up to budget table entries. Evicting a process
+// may leave its parent childless, so the walk continues up the ancestry.
+int ProcessContext::sweep(int budget) {
+  int removed = 0;
+  for (; budget > 0; --budget) {
+    ProcessTable::iterator it = m_sweep.next(m_procs, m_writer->getEpoch());
+    if (it == m_procs.end()) {
+      break;
+    }
+    ProcessObj *proc = it->second;
+    while (proc != nullptr && isEvictable(proc)) {
+      ProcessObj *parent = nullptr;
+      if (!proc->proc.poid.is_null()) {
+        OID key = proc->proc.poid.get_OID();
         ProcessTable::iterator p = m_procs.find(&key);
         if (p != m_procs.end()) {
-          ProcessObj *parentProc = p->second;
-          parentProc->children.erase(curProc->proc.oid);
-          if (parentProc->children.empty() && parentProc->netflows.empty() &&
-              parentProc->fileflows.empty() && parentProc->pfo == nullptr) {
-            curProc = parentProc;
-            poid = curProc->proc.poid;
-          } else {
-            break;
-          }
-
-        } else {
-          break;
+          parent = p->second;
+          parent->children.erase(proc->proc.oid);
         }
       }
       if (!proc->proc.containerId.is_null()) {
         m_containerCxt->derefContainer(proc->proc.containerId.get_string());
       }
-      m_procs.erase(it);
-      delete proc;
-    } else {
-      it->second->written = false;
-    }
-  }
-  for (ProcessTable::iterator it = m_procs.begin(); it != m_procs.end(); ++it) {
-    if (it->second->netflows.empty() && it->second->fileflows.empty() &&
-        it->second->children.empty() && it->second->pfo == nullptr) {
-      ProcessObj *proc = it->second;
-      if (!proc->proc.containerId.is_null()) {
-        m_containerCxt->derefContainer(proc->proc.containerId.get_string());
-      }
-      m_procs.erase(it);
+      removeProcess(proc);
       delete proc;
+      removed++;
+      proc = parent;
     }
   }
+  return removed;
 }
 
 void ProcessContext::printStats() {
@@ -453,32 +518,35 @@ void ProcessContext::printStats() {
   }
 }
 
+// Writes proc and the ancestors in the process table that were not written
+// in the current epoch, oldest first. The walk stops at the first ancestor
+// whose chain is already written in this epoch, and every process it passes
+// is marked as such, so each ancestor is visited once per epoch.
 void ProcessContext::writeProcessAndAncestors(ProcessObj *proc) {
-  Process::poid_t poid = proc->proc.poid;
-  std::vector<ProcessObj *> processes;
-  processes.push_back(proc);
-
-  while (!poid.is_null()) {
-    OID key = poid.get_OID();
-    ProcessTable::iterator p = m_procs.find(&key);
-    if (p != m_procs.end()) {
-      if (!p->second->written) {
-        processes.push_back(p->second);
-      }
-      poid = p->second->proc.poid;
-    } else {
+  m_ancestry.clear();
+  ProcessObj *p = proc;
+  size_t depth = 0;
+  while (p != nullptr && p->chainEpoch != m_writer->getEpoch() && depth <= m_procs.size()) {
+    m_ancestry.push_back(p);
+    depth++;
+    if (p->proc.poid.is_null()) {
       break;
     }
-  }
-  for (auto it = processes.rbegin(); it != processes.rend(); ++it) {
-    SF_DEBUG(m_logger, "Final: writing process " << (*it)->proc.exe << " "
-                                                 << (*it)->proc.oid.hpid);
-    ProcessObj *proc = (*it);
-    if (!proc->proc.containerId.is_null()) {
-      m_containerCxt->exportContainer(proc->proc.containerId.get_string());
+    OID key = p->proc.poid.get_OID();
+    p = getProcess(&key);
+  }
+  for (auto it = m_ancestry.rbegin(); it != m_ancestry.rend(); ++it) {
+    ProcessObj *a = (*it);
+    if (!isWritten(a)) {
+      SF_DEBUG(m_logger, "Final: writing process " << a->proc.exe << " "
+                                                   << a->proc.oid.hpid);
+      if (!a->proc.containerId.is_null()) {
+        m_containerCxt->exportContainer(a->proc.containerId.get_string());
+      }
+      m_writer->writeProcess(&(a->proc));
+      a->writtenEpoch = m_writer->getEpoch();
     }
-    m_writer->writeProcess(&((*it)->proc));
-    (*it)->written = true;
+    a->chainEpoch = m_writer->getEpoch();
   }
 }
 
@@ -486,7 +554,8 @@ void ProcessContext::printNetworkFlow(ProcessObj *proc) {
 
   for (NetworkFlowTable::iterator it = proc->netflows.begin();
        it != proc->netflows.end(); it++) {
-    cout << "Netflow: " << it->first.ip1 << " " << it->first.ip2 << " "
+    cout << "Netflow: " << nfaddrToString(it->first.ip1) << " "
+         << nfaddrToString(it->first.ip2) << " "
          << it->first.port1 << " " << it->first.port2 << " " << it->first.tid
          << " " << it->first.fd << endl;
   }
@@ -495,21 +564,23 @@ void ProcessContext::printNetworkFlow(ProcessObj *proc) {
 void ProcessContext::clearAllProcesses() {
   for (ProcessTable::iterator it = m_procs.begin(); it != m_procs.end(); ++it) {
     if (((!it->second->netflows.empty()) || (!it->second->fileflows.empty()) || (it->second->pfo != nullptr)) &&
-        !it->second->written) {
+        !isWritten(it->second)) {
       writeProcessAndAncestors(it->second);
     }
     for (NetworkFlowTable::iterator nfi = it->second->netflows.begin();
          nfi != it->second->netflows.end(); nfi++) {
       nfi->second->netflow.opFlags |= OP_TRUNCATE;
       nfi->second->netflow.endTs = utils::getSysdigTime(m_cxt);
-      m_writer->writeNetFlow(&(nfi->second->netflow));
+      if (nfi->second->hasV4Tuple()) {
+        m_writer->writeNetFlow(&(nfi->second->netflow));
+      }
       delete nfi->second;
     }
     for (FileFlowTable::iterator ffi = it->second->fileflows.begin();
          ffi != it->second->fileflows.end(); ffi++) {
       ffi->second->fileflow.opFlags |= OP_TRUNCATE;
       ffi->second->fileflow.endTs = utils::getSysdigTime(m_cxt);
-      m_fileCxt->exportFile(ffi->second->filekey);
+      m_fileCxt->exportFile(ffi->second->file);
       m_writer->writeFileFlow(&(ffi->second->fileflow));
       delete ffi->second;
     }
@@ -526,6 +597,7 @@ void ProcessContext::clearAllProcesses() {
   for (ProcessTable::iterator it = m_procs.begin(); it != m_procs.end(); ++it) {
     delete it->second;
   }
+  m_pids.clear();
 
   for (auto it = m_delProcQue.begin(); it != m_delProcQue.end(); ++it) {
     delete (*it);
@@ -553,31 +625,16 @@ void ProcessContext::deleteProcess(ProcessObj **proc) {
     m_containerCxt->derefContainer((*proc)->proc.containerId.get_string());
   }
   if((*proc)->pfo != nullptr) {
-    removeProcessFromSet(*proc, false);
+    removeProcessFromSet(*proc);
   }
-  m_procs.erase(&((*proc)->proc.oid));
+  removeProcess(*proc);
   delete *proc;
   *proc = nullptr;
 }
 
 
-int ProcessContext::removeProcessFromSet(ProcessObj *proc, bool checkForErr) {
-  bool found = false;
-  int removed = 0;
-  for (auto iter = m_pfSet.find(proc); iter != m_pfSet.end(); iter++) {
-      auto *foundObj = static_cast<ProcessObj *>(*iter);
-      if (*foundObj == *proc) {
-        SF_DEBUG(m_logger, "Removing procflow element from multiset.");
-        m_pfSet.erase(iter);
-        removed++;
-        found = true;
-        break;
-      }
-  }
-  if (!found && checkForErr) {
-    SF_ERROR(m_logger, "Cannot find Procflow Object in proc flow set. Deleting. "
-                       "This should not happen");
-  }
+int ProcessContext::removeProcessFromSet(ProcessObj *proc) {
+  int removed = m_pfSet.cancel(proc) ? 1 : 0;
   if (proc->pfo != nullptr) {
     delete proc->pfo;
     proc->pfo = nullptr;
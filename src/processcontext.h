@@ -24,6 +24,7 @@
 #include "filecontext.h"
 #include "logger.h"
 #include "op_flags.h"
+#include "sweepcursor.h"
 #include "sysflow.h"
 #include "sysflowcontext.h"
 #include "utils.h"
@@ -31,6 +32,10 @@
 
 #define PROC_TABLE_SIZE 50000
 #define PROC_DEL_EXPIRED 1.0
+#define PID_EMPTY_KEY (-3)
+#define PID_DEL_KEY (-2)
+#define EXE_ARGS_TRUNCATED "..."
+
 namespace process {
 class ProcessContext {
 private:
@@ -38,13 +43,29 @@ private:
   writer::SysFlowWriter *m_writer;
   container::ContainerContext *m_containerCxt;
   ProcessTable m_procs;
+  PidTable m_pids;
   file::FileContext *m_fileCxt;
   OIDQueue m_delProcQue;
   ProcessFlowSet m_pfSet;
   time_t m_delProcTime;
+  table::SweepCursor<ProcessTable> m_sweep;
+  std::vector<ProcessObj *> m_newProcs;
+  std::vector<ProcessObj *> m_ancestry;
   DEFINE_LOGGER();
+  inline bool isWritten(ProcessObj *proc) {
+    return proc->writtenEpoch == m_writer->getEpoch();
+  }
+  inline bool isEvictable(ProcessObj *proc) {
+    return proc->netflows.empty() && proc->fileflows.empty() &&
+           proc->children.empty() && proc->pfo == nullptr && !isWritten(proc);
+  }
+  void setExeArgs(Process *proc, sinsp_threadinfo *mainthread);
   void writeProcessAndAncestors(ProcessObj *proc);
   void reupContainer(sinsp_threadinfo *ti, ProcessObj *proc);
+  void addProcess(ProcessObj *proc);
+  void removeProcess(ProcessObj *proc);
+  void indexPid(ProcessObj *proc);
+  void unindexPid(ProcessObj *proc);
 
 public:
   ProcessContext(context::SysFlowContext *cxt,
@@ -59,14 +80,14 @@ public:
   ProcessObj *getProcess(int64_t pid);
   void printAncestors(Process *proc);
   bool isAncestor(OID *oid, Process *proc);
-  void clearProcesses();
+  int sweep(int budget);
   void clearAllProcesses();
   void deleteProcess(ProcessObj **proc);
   void markForDeletion(ProcessObj **proc);
   bool exportProcess(OID *oid);
   void printNetworkFlow(ProcessObj *proc);
   void printStats();
-  int removeProcessFromSet(ProcessObj *proc, bool checkForErr);
+  int removeProcessFromSet(ProcessObj *proc);
   inline int getSize() { return m_procs.size(); }
   inline int getNumNetworkFlows() {
     int total = 0;
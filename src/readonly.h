@@ -29,7 +29,7 @@ static std::string s_paths[NUM_PREFIXES] = {
     "/proc/", "/dev/",   "/sys/",     "//sys/",
     "/lib/",  "/lib64/", "/usr/lib/", "/usr/lib64/"};
 
-inline bool prefix_match(std::string path, std::string match) {
+inline bool prefix_match(const std::string &path, const std::string &match) {
   if (path.length() < match.length()) {
     return false;
   }
@@ -42,6 +42,15 @@ inline bool prefix_match(std::string path, std::string match) {
   return true;
 }
 
+inline bool is_select_path(const std::string &path) {
+  for (int i = 0; i < NUM_PREFIXES; i++) {
+    if (prefix_match(path, s_paths[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
 #define SHOULD_WRITE(ff)                                                       \
   int readMode = m_cxt->getFileRead();                                         \
   bool match = false;                                                          \
@@ -51,12 +60,7 @@ inline bool prefix_match(std::string path, std::string match) {
         (ff->fileflow.opFlags & OP_WRITE_SEND) != OP_WRITE_SEND &&             \
         (ff->fileflow.opFlags & OP_MMAP) != OP_MMAP))) {                       \
     if (readMode != FILE_READS_DISABLED) {                                     \
-      for (int i = 0; i < NUM_PREFIXES; i++) {                                 \
-        if (prefix_match(ff->flowkey, s_paths[i])) {                           \
-          match = true;                                                        \
-          break;                                                               \
-        }                                                                      \
-      }                                                                        \
+      match = ff->selectPath;                                                  \
     } else {                                                                   \
       match = true;                                                            \
     }                                                                          \
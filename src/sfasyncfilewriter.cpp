@@ -0,0 +1,250 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "sfasyncfilewriter.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <random>
+#include <unistd.h>
+
+using writer::SFAsyncFileWriter;
+
+CREATE_LOGGER(SFAsyncFileWriter, "sysflow.sfasyncfilewriter");
+
+static const uint8_t s_magic[AVRO_MAGIC_SIZE] = {'O', 'b', 'j', 1};
+
+static inline void appendLong(std::vector<uint8_t> *buf, int64_t v) {
+  uint64_t n = (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+  while ((n & ~0x7FULL) != 0) {
+    buf->push_back(static_cast<uint8_t>((n & 0x7F) | 0x80));
+    n >>= 7;
+  }
+  buf->push_back(static_cast<uint8_t>(n));
+}
+
+SFAsyncFileWriter::SFAsyncFileWriter(context::SysFlowContext *cxt,
+                                     time_t start)
+    : writer::SFFileWriter(cxt, start),
+      m_blocks(cxt->getAsyncWriterBuffers()), m_running(false),
+      m_cur(nullptr), m_blockSize(cxt->getCompressBlockSize()),
+      m_failed(false), m_fd(-1), m_sync(),
+      m_codec(BlockCodec::create(cxt->getCompressCodec(),
+                                 cxt->getCompressLevel())),
+      m_numBlocks(0), m_bufferWaits(0) {
+  for (auto it = m_blocks.begin(); it != m_blocks.end(); ++it) {
+    it->data.reserve(m_blockSize + BUFFER_STREAM_CHUNK);
+    m_free.push_back(&(*it));
+  }
+  m_cur = m_free.back();
+  m_free.pop_back();
+  m_out = std::unique_ptr<BufferOutputStream>(
+      new BufferOutputStream(&(m_cur->data)));
+  m_encoder = avro::binaryEncoder();
+  m_encoder->init(*m_out);
+}
+
+SFAsyncFileWriter::~SFAsyncFileWriter() {
+  try {
+    stop();
+  } catch (...) {
+    SF_ERROR(m_logger, "Caught exception while flushing async file writer");
+  }
+}
+
+int SFAsyncFileWriter::initialize() {
+  m_running = true;
+  m_worker = std::thread(&SFAsyncFileWriter::runWorker, this);
+  time_t curTime = time(nullptr);
+  openFile(curTime);
+  writeHeader();
+  return 0;
+}
+
+void SFAsyncFileWriter::reset(time_t curTime) {
+  submitBlock();
+  m_numRecs = 0;
+  openFile(curTime);
+  m_start = curTime;
+  writeHeader();
+}
+
+void SFAsyncFileWriter::openFile(time_t curTime) {
+  static std::mt19937_64 s_rng{std::random_device{}()};
+  BlockJob job;
+  job.cmd = BLOCK_OPEN;
+  job.block = nullptr;
+  job.path = getFileName(curTime);
+  for (size_t i = 0; i < AVRO_SYNC_SIZE; i++) {
+    job.sync[i] = static_cast<uint8_t>(s_rng());
+  }
+  std::map<string, std::vector<uint8_t>> meta;
+  string schema = m_sysfSchema.toJson(false);
+  meta[AVRO_SCHEMA_KEY] = std::vector<uint8_t>(schema.begin(), schema.end());
+  string codec = m_codec->name();
+  meta[AVRO_CODEC_KEY] = std::vector<uint8_t>(codec.begin(), codec.end());
+  job.header.assign(s_magic, s_magic + AVRO_MAGIC_SIZE);
+  BufferOutputStream out(&(job.header));
+  avro::EncoderPtr encoder = avro::binaryEncoder();
+  encoder->init(out);
+  avro::encode(*encoder, meta);
+  encoder->flush();
+  job.header.insert(job.header.end(), job.sync.begin(), job.sync.end());
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_jobs.push_back(std::move(job));
+  m_jobCond.notify_one();
+}
+
+void SFAsyncFileWriter::submitBlock() {
+  if (m_failed.load(std::memory_order_acquire)) {
+    throw avro::Exception(m_error);
+  }
+  if (m_cur->count == 0) {
+    return;
+  }
+  BlockJob job;
+  job.cmd = BLOCK_DATA;
+  job.block = m_cur;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+    m_jobCond.notify_one();
+  }
+  nextBlock();
+}
+
+void SFAsyncFileWriter::nextBlock() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_free.empty()) {
+    m_bufferWaits++;
+    m_freeCond.wait(lock, [this] { return !m_free.empty(); });
+  }
+  m_cur = m_free.back();
+  m_free.pop_back();
+  lock.unlock();
+  m_cur->data.clear();
+  m_cur->count = 0;
+  m_out->setBuffer(&(m_cur->data));
+}
+
+void SFAsyncFileWriter::stop() {
+  if (!m_running) {
+    return;
+  }
+  m_running = false;
+  submitBlock();
+  BlockJob job;
+  job.cmd = BLOCK_STOP;
+  job.block = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+    m_jobCond.notify_one();
+  }
+  m_worker.join();
+  printStats();
+}
+
+void SFAsyncFileWriter::runWorker() {
+  while (true) {
+    BlockJob job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_jobCond.wait(lock, [this] { return !m_jobs.empty(); });
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    if (job.cmd == BLOCK_DATA) {
+      if (!m_failed.load(std::memory_order_relaxed)) {
+        writeBlock(job.block);
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_free.push_back(job.block);
+      m_freeCond.notify_one();
+    } else if (job.cmd == BLOCK_OPEN) {
+      if (m_fd >= 0) {
+        close(m_fd);
+      }
+      m_fd = open(job.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (m_fd < 0) {
+        fail("Unable to open sysflow file " + job.path + ": " +
+             std::strerror(errno));
+        continue;
+      }
+      m_sync = job.sync;
+      writeBytes(job.header.data(), job.header.size());
+    } else {
+      if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+      }
+      break;
+    }
+  }
+}
+
+void SFAsyncFileWriter::writeBlock(AvroBlock *block) {
+  const std::vector<uint8_t> *out = m_codec->compress(block->data);
+  if (out == nullptr) {
+    fail(string("Unable to compress sysflow block with codec ") +
+         m_codec->name());
+    return;
+  }
+  m_frame.clear();
+  appendLong(&m_frame, block->count);
+  appendLong(&m_frame, static_cast<int64_t>(out->size()));
+  writeBytes(m_frame.data(), m_frame.size());
+  writeBytes(out->data(), out->size());
+  writeBytes(m_sync.data(), m_sync.size());
+  m_numBlocks++;
+}
+
+void SFAsyncFileWriter::writeBytes(const uint8_t *data, size_t len) {
+  while (len > 0 && m_fd >= 0) {
+    ssize_t n = ::write(m_fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      fail(string("Unable to write sysflow file: ") + std::strerror(errno));
+      return;
+    }
+    data += n;
+    len -= n;
+  }
+}
+
+void SFAsyncFileWriter::fail(const string &msg) {
+  SF_ERROR(m_logger, msg);
+  if (!m_failed.load(std::memory_order_relaxed)) {
+    m_error = msg;
+    m_failed.store(true, std::memory_order_release);
+  }
+}
+
+void SFAsyncFileWriter::printStats() {
+  SF_INFO(m_logger, "Async file writer: Blocks: "
+                        << m_numBlocks << " Buffer Waits: " << m_bufferWaits);
+  SF_INFO(m_logger, "Codec: " << m_codec->name() << " Bytes In: "
+                              << m_codec->getBytesIn() << " Bytes Out: "
+                              << m_codec->getBytesOut()
+                              << " Ratio: " << m_codec->getRatio()
+                              << " MB/s: " << m_codec->getThroughput());
+}
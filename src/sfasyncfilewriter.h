@@ -0,0 +1,135 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_ASYNC_FILE_WRITER_
+#define __SF_ASYNC_FILE_WRITER_
+#include "avro/Encoder.hh"
+#include "avro/Specific.hh"
+#include "bufferstream.h"
+#include "logger.h"
+#include "sfcodec.h"
+#include "sffilewriter.h"
+#include "sysflow.h"
+#include "sysflowcontext.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#define AVRO_MAGIC_SIZE 4
+#define AVRO_SYNC_SIZE 16
+#define AVRO_SCHEMA_KEY "avro.schema"
+#define AVRO_CODEC_KEY "avro.codec"
+
+using sysflow::SysFlow;
+
+namespace writer {
+typedef std::array<uint8_t, AVRO_SYNC_SIZE> SyncMarker;
+
+struct AvroBlock {
+  std::vector<uint8_t> data;
+  int64_t count{0};
+};
+
+enum BlockCmd { BLOCK_DATA, BLOCK_OPEN, BLOCK_STOP };
+
+struct BlockJob {
+  BlockCmd cmd;
+  AvroBlock *block;
+  string path;
+  std::vector<uint8_t> header;
+  SyncMarker sync;
+};
+
+/**
+ * Avro object container writer that keeps compression and file I/O off the
+ * event loop. Records are serialized into an in-memory block; full blocks are
+ * handed to a worker thread that compresses them with the configured codec
+ * and appends them, framed as in avro::DataFileWriter, to the current file.
+ * The event loop only waits when every block buffer is in flight.
+ **/
+class SFAsyncFileWriter : public writer::SFFileWriter {
+private:
+  std::vector<AvroBlock> m_blocks;
+  std::vector<AvroBlock *> m_free;
+  std::deque<BlockJob> m_jobs;
+  std::mutex m_mutex;
+  std::condition_variable m_jobCond;
+  std::condition_variable m_freeCond;
+  std::thread m_worker;
+  bool m_running;
+  AvroBlock *m_cur;
+  std::unique_ptr<BufferOutputStream> m_out;
+  avro::EncoderPtr m_encoder;
+  size_t m_blockSize;
+  std::atomic<bool> m_failed;
+  string m_error;
+  // worker state
+  int m_fd;
+  SyncMarker m_sync;
+  std::unique_ptr<BlockCodec> m_codec;
+  std::vector<uint8_t> m_frame;
+  std::atomic<uint64_t> m_numBlocks;
+  uint64_t m_bufferWaits;
+  DEFINE_LOGGER();
+  void openFile(time_t curTime);
+  void submitBlock();
+  void nextBlock();
+  void runWorker();
+  void writeBlock(AvroBlock *block);
+  void writeBytes(const uint8_t *data, size_t len);
+  void fail(const string &msg);
+  void stop();
+  inline avro::Encoder *beginRecord() {
+    if (m_cur->data.size() >= m_blockSize) {
+      submitBlock();
+    }
+    return m_encoder.get();
+  }
+  inline void endRecord() {
+    m_encoder->flush();
+    m_cur->count++;
+  }
+
+public:
+  SFAsyncFileWriter(context::SysFlowContext *cxt, time_t start);
+  virtual ~SFAsyncFileWriter();
+  inline void write(SysFlow *flow) {
+    if (m_cur->data.size() >= m_blockSize) {
+      submitBlock();
+    }
+    avro::encode(*m_encoder, *flow);
+    m_encoder->flush();
+    m_cur->count++;
+  }
+  inline void writeEncoded(const uint8_t *data, size_t len) {
+    if (m_cur->data.size() >= m_blockSize) {
+      submitBlock();
+    }
+    m_cur->data.insert(m_cur->data.end(), data, data + len);
+    m_cur->count++;
+  }
+  int initialize();
+  void reset(time_t curTime);
+  void printStats();
+};
+} // namespace writer
+#endif
@@ -0,0 +1,123 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "sfcodec.h"
+#include <chrono>
+#include <snappy.h>
+
+using writer::BlockCodec;
+using writer::DeflateCodec;
+using writer::NullCodec;
+using writer::SnappyCodec;
+using writer::ZstdCodec;
+
+const std::vector<uint8_t> *
+BlockCodec::compress(const std::vector<uint8_t> &in) {
+  auto begin = std::chrono::steady_clock::now();
+  const std::vector<uint8_t> *out = encode(in);
+  auto end = std::chrono::steady_clock::now();
+  m_nanos +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+  m_bytesIn += in.size();
+  if (out != nullptr) {
+    m_bytesOut += out->size();
+  }
+  return out;
+}
+
+BlockCodec *BlockCodec::create(const std::string &codec, int level) {
+  if (codec == CODEC_NULL) {
+    return new NullCodec();
+  }
+  if (codec == CODEC_SNAPPY) {
+    return new SnappyCodec();
+  }
+  if (codec == CODEC_ZSTD || codec == CODEC_ZSTANDARD) {
+    return new ZstdCodec(level);
+  }
+  return new DeflateCodec(level);
+}
+
+DeflateCodec::DeflateCodec(int level) : m_zstrm(), m_init(false) {
+  if (level == CODEC_DEFAULT_LEVEL) {
+    level = Z_DEFAULT_COMPRESSION;
+  }
+  // avro deflate blocks are raw deflate streams (no zlib header).
+  m_init = (deflateInit2(&m_zstrm, level, Z_DEFLATED, -15, 8,
+                         Z_DEFAULT_STRATEGY) == Z_OK);
+}
+
+DeflateCodec::~DeflateCodec() {
+  if (m_init) {
+    deflateEnd(&m_zstrm);
+  }
+}
+
+const std::vector<uint8_t> *
+DeflateCodec::encode(const std::vector<uint8_t> &in) {
+  if (!m_init || deflateReset(&m_zstrm) != Z_OK) {
+    return nullptr;
+  }
+  m_out.resize(deflateBound(&m_zstrm, in.size()));
+  m_zstrm.next_in = const_cast<Bytef *>(in.data());
+  m_zstrm.avail_in = in.size();
+  m_zstrm.next_out = m_out.data();
+  m_zstrm.avail_out = m_out.size();
+  if (deflate(&m_zstrm, Z_FINISH) != Z_STREAM_END) {
+    return nullptr;
+  }
+  m_out.resize(m_zstrm.total_out);
+  return &m_out;
+}
+
+const std::vector<uint8_t> *
+SnappyCodec::encode(const std::vector<uint8_t> &in) {
+  size_t len = 0;
+  m_out.resize(snappy::MaxCompressedLength(in.size()) + 4);
+  snappy::RawCompress(reinterpret_cast<const char *>(in.data()), in.size(),
+                      reinterpret_cast<char *>(m_out.data()), &len);
+  // avro snappy blocks end with the big endian CRC32 of the uncompressed data.
+  uint32_t crc = crc32(0L, in.data(), in.size());
+  m_out[len] = static_cast<uint8_t>(crc >> 24);
+  m_out[len + 1] = static_cast<uint8_t>(crc >> 16);
+  m_out[len + 2] = static_cast<uint8_t>(crc >> 8);
+  m_out[len + 3] = static_cast<uint8_t>(crc);
+  m_out.resize(len + 4);
+  return &m_out;
+}
+
+ZstdCodec::ZstdCodec(int level)
+    : m_cctx(ZSTD_createCCtx()),
+      m_level(level == CODEC_DEFAULT_LEVEL ? ZSTD_FAST_LEVEL : level) {}
+
+ZstdCodec::~ZstdCodec() { ZSTD_freeCCtx(m_cctx); }
+
+const std::vector<uint8_t> *ZstdCodec::encode(const std::vector<uint8_t> &in) {
+  if (m_cctx == nullptr) {
+    return nullptr;
+  }
+  m_out.resize(ZSTD_compressBound(in.size()));
+  size_t len = ZSTD_compressCCtx(m_cctx, m_out.data(), m_out.size(), in.data(),
+                                 in.size(), m_level);
+  if (ZSTD_isError(len) != 0u) {
+    return nullptr;
+  }
+  m_out.resize(len);
+  return &m_out;
+}
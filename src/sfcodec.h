@@ -0,0 +1,121 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_CODEC_
+#define __SF_CODEC_
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <zstd.h>
+
+#define CODEC_NULL "null"
+#define CODEC_DEFLATE "deflate"
+#define CODEC_SNAPPY "snappy"
+#define CODEC_ZSTD "zstd"
+#define CODEC_ZSTANDARD "zstandard"
+#define CODEC_DEFAULT_LEVEL (-1)
+#define ZSTD_FAST_LEVEL 1
+
+namespace writer {
+/**
+ * Compresses avro object container blocks. Implementations produce the block
+ * payload expected by the avro codec they are named after, so files remain
+ * readable by standard avro readers.
+ **/
+class BlockCodec {
+private:
+  std::atomic<uint64_t> m_bytesIn;
+  std::atomic<uint64_t> m_bytesOut;
+  std::atomic<uint64_t> m_nanos;
+
+protected:
+  std::vector<uint8_t> m_out;
+  // returns the encoded block, or nullptr if the block cannot be compressed.
+  virtual const std::vector<uint8_t> *
+  encode(const std::vector<uint8_t> &in) = 0;
+
+public:
+  BlockCodec() : m_bytesIn(0), m_bytesOut(0), m_nanos(0) {}
+  virtual ~BlockCodec() {}
+  // avro.codec metadata value.
+  virtual const char *name() = 0;
+  const std::vector<uint8_t> *compress(const std::vector<uint8_t> &in);
+  inline uint64_t getBytesIn() { return m_bytesIn; }
+  inline uint64_t getBytesOut() { return m_bytesOut; }
+  inline double getRatio() {
+    uint64_t out = m_bytesOut;
+    return out > 0 ? static_cast<double>(m_bytesIn) / out : 0;
+  }
+  // MB of uncompressed input per second spent compressing.
+  inline double getThroughput() {
+    uint64_t nanos = m_nanos;
+    return nanos > 0 ? (m_bytesIn / 1048576.0) / (nanos / 1e9) : 0;
+  }
+  static BlockCodec *create(const std::string &codec, int level);
+};
+
+class NullCodec : public BlockCodec {
+protected:
+  const std::vector<uint8_t> *encode(const std::vector<uint8_t> &in) {
+    return &in;
+  }
+
+public:
+  const char *name() { return CODEC_NULL; }
+};
+
+class DeflateCodec : public BlockCodec {
+private:
+  z_stream m_zstrm;
+  bool m_init;
+
+protected:
+  const std::vector<uint8_t> *encode(const std::vector<uint8_t> &in);
+
+public:
+  explicit DeflateCodec(int level);
+  virtual ~DeflateCodec();
+  const char *name() { return CODEC_DEFLATE; }
+};
+
+class SnappyCodec : public BlockCodec {
+protected:
+  const std::vector<uint8_t> *encode(const std::vector<uint8_t> &in);
+
+public:
+  const char *name() { return CODEC_SNAPPY; }
+};
+
+class ZstdCodec : public BlockCodec {
+private:
+  ZSTD_CCtx *m_cctx;
+  int m_level;
+
+protected:
+  const std::vector<uint8_t> *encode(const std::vector<uint8_t> &in);
+
+public:
+  explicit ZstdCodec(int level);
+  virtual ~ZstdCodec();
+  const char *name() { return CODEC_ZSTANDARD; }
+};
+} // namespace writer
+#endif
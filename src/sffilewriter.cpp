@@ -36,13 +36,20 @@ SFFileWriter::~SFFileWriter() {
 int SFFileWriter::initialize() {
   time_t curTime = time(nullptr);
   string ofile = getFileName(curTime);
-  m_dfw = new avro::DataFileWriter<SysFlow>(ofile.c_str(), m_sysfSchema,
-                                            COMPRESS_BLOCK_SIZE,
-                                            avro::Codec::DEFLATE_CODEC);
+  m_dfw = new avro::DataFileWriterBase(ofile.c_str(), m_sysfSchema,
+                                       m_cxt->getCompressBlockSize(),
+                                       getAvroCodec());
   writeHeader();
   return 0;
 }
 
+avro::Codec SFFileWriter::getAvroCodec() {
+  if (m_cxt->getCompressCodec() == CODEC_NULL) {
+    return avro::Codec::NULL_CODEC;
+  }
+  return avro::Codec::DEFLATE_CODEC;
+}
+
 string SFFileWriter::getFileName(time_t curTime) {
   string ofile;
   if (m_start > 0) {
@@ -66,9 +73,9 @@ void SFFileWriter::reset(time_t curTime) {
   m_numRecs = 0;
   m_dfw->close();
   delete m_dfw;
-  m_dfw = new avro::DataFileWriter<SysFlow>(ofile.c_str(), m_sysfSchema,
-                                            COMPRESS_BLOCK_SIZE,
-                                            avro::Codec::DEFLATE_CODEC);
+  m_dfw = new avro::DataFileWriterBase(ofile.c_str(), m_sysfSchema,
+                                       m_cxt->getCompressBlockSize(),
+                                       getAvroCodec());
   m_start = curTime;
   writeHeader();
 }
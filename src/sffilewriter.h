@@ -27,22 +27,39 @@
 #include "sysflow.h"
 #include "sysflowcontext.h"
 #include "sysflowwriter.h"
+#include "sfcodec.h"
 #include "utils.h"
-#define COMPRESS_BLOCK_SIZE 80000
 
 using sysflow::SysFlow;
 
 namespace writer {
 class SFFileWriter : public writer::SysFlowWriter {
 private:
+  avro::DataFileWriterBase *m_dfw;
+
+protected:
   avro::ValidSchema m_sysfSchema;
-  avro::DataFileWriter<SysFlow> *m_dfw;
   string getFileName(time_t curTime);
+  avro::Codec getAvroCodec();
+  inline avro::Encoder *beginRecord() {
+    m_dfw->syncIfNeeded();
+    return &(m_dfw->encoder());
+  }
+  inline void endRecord() { m_dfw->incr(); }
 
 public:
   SFFileWriter(context::SysFlowContext *cxt, time_t start);
   virtual ~SFFileWriter();
-  inline void write(SysFlow *flow) { m_dfw->write(*flow); }
+  inline void write(SysFlow *flow) {
+    m_dfw->syncIfNeeded();
+    avro::encode(m_dfw->encoder(), *flow);
+    m_dfw->incr();
+  }
+  inline void writeEncoded(const uint8_t *data, size_t len) {
+    m_dfw->syncIfNeeded();
+    m_dfw->encoder().writeFixed(data, len);
+    m_dfw->incr();
+  }
   int initialize();
   void reset(time_t curTime);
 };
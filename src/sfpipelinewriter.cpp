@@ -0,0 +1,221 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#include "sfpipelinewriter.h"
+
+using writer::SFPipelineWriter;
+
+CREATE_LOGGER(SFPipelineWriter, "sysflow.sfpipelinewriter");
+
+SFPipelineWriter::SFPipelineWriter(context::SysFlowContext *cxt, time_t start,
+                                   SysFlowWriter *sink)
+    : writer::SysFlowWriter(cxt, start), m_sink(sink),
+      m_flowQue(cxt->getPipelineQueueSize()),
+      m_encQue(cxt->getPipelineQueueSize()), m_running(false),
+      m_headerRecs(0), m_ioPark(PIPELINE_PARK_TIMEOUT), m_failed(false),
+      m_captureStalls(0), m_encodeStalls(0), m_encoded(0), m_written(0) {}
+
+SFPipelineWriter::~SFPipelineWriter() {
+  stop();
+  delete m_sink;
+}
+
+int SFPipelineWriter::initialize() {
+  // the sink opens its output and writes the header before any stage runs.
+  int res = m_sink->initialize();
+  // records the sink writes on its own at the start of every file.
+  m_headerRecs = m_sink->getNumRecs();
+  m_numRecs = m_headerRecs;
+  // batching sinks are flushed from the I/O thread, so it wakes up at least
+  // once per batch deadline while idle.
+  uint64_t interval = m_sink->getFlushInterval();
+  if (interval > 0 && interval < PIPELINE_PARK_TIMEOUT) {
+    m_ioPark = std::chrono::nanoseconds(interval);
+  }
+  m_running = true;
+  m_encoder = std::thread(&SFPipelineWriter::runEncoder, this);
+  m_io = std::thread(&SFPipelineWriter::runIO, this);
+  return res;
+}
+
+inline writer::FlowSlot *SFPipelineWriter::acquireFlowSlot() {
+  if (m_failed.load(std::memory_order_acquire)) {
+    throw avro::Exception(m_error);
+  }
+  return waitFlowSlot();
+}
+
+inline writer::FlowSlot *SFPipelineWriter::waitFlowSlot() {
+  FlowSlot *slot = m_flowQue.acquire();
+  if (slot == nullptr) {
+    m_captureStalls++;
+    int spins = 0;
+    while ((slot = m_flowQue.acquire()) == nullptr) {
+      backoff(spins);
+    }
+  }
+  return slot;
+}
+
+void SFPipelineWriter::write(SysFlow *flow) {
+  FlowSlot *slot = acquireFlowSlot();
+  slot->cmd = STAGE_DATA;
+  // the record was just set on the writer's scratch SysFlow, which is set
+  // again before its next use, so its union value is moved rather than
+  // copied.
+  slot->flow = std::move(*flow);
+  m_flowQue.commit();
+}
+
+void SFPipelineWriter::writeEncoded(const uint8_t * /*data*/,
+                                    size_t /*len*/) {
+  SF_ERROR(m_logger, "Pipeline writer cannot be used as a pipeline sink.");
+}
+
+void SFPipelineWriter::reset(time_t curTime) {
+  FlowSlot *slot = acquireFlowSlot();
+  slot->cmd = STAGE_ROTATE;
+  slot->time = curTime;
+  m_flowQue.commit();
+  m_start = curTime;
+  // the sink writes the new file header on the I/O thread.
+  m_numRecs = m_headerRecs;
+}
+
+// surfaces an I/O stage failure on the capture thread; the I/O thread does
+// the sink's own flushing.
+void SFPipelineWriter::flush() {
+  if (m_failed.load(std::memory_order_acquire)) {
+    throw avro::Exception(m_error);
+  }
+}
+
+void SFPipelineWriter::stop() {
+  if (!m_running) {
+    return;
+  }
+  FlowSlot *slot = waitFlowSlot();
+  slot->cmd = STAGE_STOP;
+  m_flowQue.commit();
+  m_encoder.join();
+  m_io.join();
+  m_running = false;
+  printStats();
+  if (m_failed.load(std::memory_order_acquire)) {
+    SF_ERROR(m_logger, "Pipeline writer stopped after an I/O stage failure, "
+                           << m_encoded - m_written
+                           << " records dropped. Error: " << m_error);
+  }
+}
+
+void SFPipelineWriter::runEncoder() {
+  std::vector<uint8_t> scratch;
+  BufferOutputStream out(&scratch);
+  avro::EncoderPtr encoder = avro::binaryEncoder();
+  int spins = 0;
+  while (true) {
+    FlowSlot *in = m_flowQue.peek();
+    if (in == nullptr) {
+      m_flowQue.wait(spins, std::chrono::nanoseconds(PIPELINE_PARK_TIMEOUT));
+      continue;
+    }
+    spins = 0;
+    EncodedSlot *slot = m_encQue.acquire();
+    if (slot == nullptr) {
+      m_encodeStalls++;
+      int s = 0;
+      while ((slot = m_encQue.acquire()) == nullptr) {
+        backoff(s);
+      }
+    }
+    StageCmd cmd = in->cmd;
+    slot->cmd = cmd;
+    slot->time = in->time;
+    if (cmd == STAGE_DATA) {
+      slot->data.clear();
+      out.setBuffer(&(slot->data));
+      encoder->init(out);
+      avro::encode(*encoder, in->flow);
+      encoder->flush();
+      m_encoded++;
+    }
+    m_flowQue.release();
+    m_encQue.commit();
+    if (cmd == STAGE_STOP) {
+      break;
+    }
+  }
+}
+
+void SFPipelineWriter::runIO() {
+  int spins = 0;
+  while (true) {
+    EncodedSlot *slot = m_encQue.peek();
+    if (slot == nullptr) {
+      // the sink is only touched from this thread, so idle flushes go here,
+      // once per park rather than on every poll.
+      if (spins >= SPSC_PARK_SPINS &&
+          !m_failed.load(std::memory_order_relaxed)) {
+        m_sink->flush();
+      }
+      m_encQue.wait(spins, m_ioPark);
+      continue;
+    }
+    spins = 0;
+    StageCmd cmd = slot->cmd;
+    if (cmd == STAGE_STATS) {
+      m_sink->printStats();
+    } else if (!m_failed.load(std::memory_order_relaxed)) {
+      try {
+        if (cmd == STAGE_DATA) {
+          m_sink->writeEncoded(slot->data.data(), slot->data.size());
+          m_written++;
+        } else if (cmd == STAGE_ROTATE) {
+          m_sink->reset(slot->time);
+        }
+      } catch (avro::Exception &ex) {
+        SF_ERROR(m_logger, "Avro Exception in pipeline I/O stage! Error: "
+                               << ex.what());
+        m_error = ex.what();
+        m_failed.store(true, std::memory_order_release);
+      }
+    }
+    m_encQue.release();
+    if (cmd == STAGE_STOP) {
+      break;
+    }
+  }
+}
+
+void SFPipelineWriter::printStats() {
+  SF_INFO(m_logger, "Pipeline: Encoded: "
+                        << m_encoded << " Written: " << m_written
+                        << " Capture Stalls: " << m_captureStalls
+                        << " Encode Stalls: " << m_encodeStalls
+                        << " Capture Queue: " << m_flowQue.size() << "/"
+                        << m_flowQue.capacity() << " Encode Queue: "
+                        << m_encQue.size() << "/" << m_encQue.capacity());
+  if (!m_running) {
+    m_sink->printStats();
+    return;
+  }
+  FlowSlot *slot = waitFlowSlot();
+  slot->cmd = STAGE_STATS;
+  m_flowQue.commit();
+}
@@ -0,0 +1,98 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_PIPELINE_WRITER_
+#define __SF_PIPELINE_WRITER_
+#include "avro/Encoder.hh"
+#include "bufferstream.h"
+#include "logger.h"
+#include "spscqueue.h"
+#include "sysflow.h"
+#include "sysflowcontext.h"
+#include "sysflowwriter.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// longest a stage parks on an empty ring before checking again, in ns.
+#define PIPELINE_PARK_TIMEOUT 100000000
+
+using sysflow::SysFlow;
+
+namespace writer {
+enum StageCmd { STAGE_DATA, STAGE_ROTATE, STAGE_STATS, STAGE_STOP };
+
+struct FlowSlot {
+  StageCmd cmd{STAGE_DATA};
+  time_t time{0};
+  SysFlow flow;
+};
+
+struct EncodedSlot {
+  StageCmd cmd{STAGE_DATA};
+  time_t time{0};
+  std::vector<uint8_t> data;
+};
+
+/**
+ * Staged writer: the capture thread moves finished records into a ring, an
+ * encoder thread serializes them to avro binary, and an I/O thread hands the
+ * encoded bytes to the wrapped sink (compression and file/socket I/O). Both
+ * rings are FIFO, so records leave in the order the capture thread produced
+ * them. Rotations travel through the rings as markers so that they are
+ * applied between the same records as in the single threaded writer. The
+ * sink is only touched from the I/O thread, so its stats travel the same way.
+ **/
+class SFPipelineWriter : public writer::SysFlowWriter {
+private:
+  SysFlowWriter *m_sink;
+  SPSCQueue<FlowSlot> m_flowQue;
+  SPSCQueue<EncodedSlot> m_encQue;
+  std::thread m_encoder;
+  std::thread m_io;
+  bool m_running;
+  int m_headerRecs;
+  std::chrono::nanoseconds m_ioPark;
+  std::atomic<bool> m_failed;
+  std::string m_error;
+  std::atomic<uint64_t> m_captureStalls;
+  std::atomic<uint64_t> m_encodeStalls;
+  std::atomic<uint64_t> m_encoded;
+  std::atomic<uint64_t> m_written;
+  DEFINE_LOGGER();
+  FlowSlot *acquireFlowSlot();
+  FlowSlot *waitFlowSlot();
+  void runEncoder();
+  void runIO();
+  void stop();
+
+public:
+  SFPipelineWriter(context::SysFlowContext *cxt, time_t start,
+                   SysFlowWriter *sink);
+  virtual ~SFPipelineWriter();
+  void write(SysFlow *flow);
+  void writeEncoded(const uint8_t *data, size_t len);
+  int initialize();
+  void reset(time_t curTime);
+  void flush();
+  void printStats();
+};
+} // namespace writer
+#endif
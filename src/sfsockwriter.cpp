@@ -24,14 +24,30 @@ using writer::SFSocketWriter;
 CREATE_LOGGER(SFSocketWriter, "sysflow.sfsocketwriter");
 
 SFSocketWriter::SFSocketWriter(context::SysFlowContext *cxt, time_t start)
-    : writer::SysFlowWriter(cxt, start), m_sock(0) {
+    : writer::SysFlowWriter(cxt, start), m_sock(0),
+      m_batchSize(cxt->getSockBatchSize()),
+      m_batchLatency(cxt->getSockBatchLatency()), m_numBatches(0),
+      m_numMsgs(0), m_numErrors(0) {
   m_sockPath = m_cxt->getOutputFile();
+  m_arena.reserve(m_batchSize * SOCK_RECORD_SIZE_HINT);
+  m_ends.reserve(m_batchSize);
+  m_msgs.resize(m_batchSize);
+  m_iovs.resize(m_batchSize);
+  memset(m_msgs.data(), 0, m_msgs.size() * sizeof(struct mmsghdr));
+  for (size_t i = 0; i < m_batchSize; i++) {
+    m_msgs[i].msg_hdr.msg_iov = &m_iovs[i];
+    m_msgs[i].msg_hdr.msg_iovlen = 1;
+  }
 }
 
-SFSocketWriter::~SFSocketWriter() { close(m_sock); }
+SFSocketWriter::~SFSocketWriter() {
+  sendBatch();
+  close(m_sock);
+}
 
 int SFSocketWriter::initialize() {
-  m_outStream = avro::ostreamOutputStream(m_stringStream, 16);
+  m_outStream =
+      std::unique_ptr<BufferOutputStream>(new BufferOutputStream(&m_arena));
   m_encoder = avro::binaryEncoder();
   m_encoder->init(*m_outStream);
   struct sockaddr_un addr;
@@ -58,3 +74,63 @@ void SFSocketWriter::reset(time_t curTime) {
   m_start = curTime;
   writeHeader();
 }
+
+void SFSocketWriter::sendBatch() {
+  size_t num = m_ends.size();
+  if (num == 0) {
+    return;
+  }
+  if (num == 1) {
+    if (send(m_sock, (const void *)m_arena.data(), m_ends[0], 0) < 0) {
+      SF_ERROR(m_logger, "Unable to send on domain socket:  "
+                             << m_sockPath
+                             << ". Error Code: " << std::strerror(errno));
+      m_numErrors++;
+    }
+  } else {
+    size_t begin = 0;
+    for (size_t i = 0; i < num; i++) {
+      m_iovs[i].iov_base = m_arena.data() + begin;
+      m_iovs[i].iov_len = m_ends[i] - begin;
+      begin = m_ends[i];
+    }
+    size_t sent = 0;
+    while (sent < num) {
+      int res = sendmmsg(m_sock, &m_msgs[sent], num - sent, 0);
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        SF_ERROR(m_logger, "Unable to send on domain socket:  "
+                               << m_sockPath
+                               << ". Error Code: " << std::strerror(errno));
+        // drop the failing record and carry on with the rest of the batch.
+        m_numErrors++;
+        sent++;
+        continue;
+      }
+      sent += res;
+    }
+  }
+  m_numBatches++;
+  m_numMsgs += num;
+  m_ends.clear();
+  m_arena.clear();
+}
+
+void SFSocketWriter::flush() {
+  if (!m_ends.empty() &&
+      std::chrono::steady_clock::now() - m_batchStart >= m_batchLatency) {
+    sendBatch();
+  }
+}
+
+void SFSocketWriter::printStats() {
+  SF_INFO(m_logger, "Socket writer: Messages: "
+                        << m_numMsgs << " Batches: " << m_numBatches
+                        << " Avg Batch: "
+                        << (m_numBatches > 0
+                                ? static_cast<double>(m_numMsgs) / m_numBatches
+                                : 0)
+                        << " Send Errors: " << m_numErrors);
+}
@@ -21,26 +21,59 @@
 #define __SF_SOCK_WRITER_
 #include "avro/Decoder.hh"
 #include "avro/Encoder.hh"
+#include "bufferstream.h"
 #include "sysflow.h"
 #include "sysflowcontext.h"
 #include "sysflowwriter.h"
 #include "utils.h"
+#include <chrono>
 #include <netinet/in.h>
-#include <sstream>
 #include <sys/socket.h>
 #include <sys/un.h>
 
+#define SOCK_RECORD_SIZE_HINT 512
+
 using sysflow::SysFlow;
 
 namespace writer {
+/**
+ * Writes each record as one SEQPACKET message on a unix domain socket.
+ * Records are encoded back to back into a reusable arena; with batching
+ * enabled, pending records are sent with a single sendmmsg() call once the
+ * batch is full or the oldest pending record exceeds the latency budget.
+ **/
 class SFSocketWriter : public writer::SysFlowWriter {
 private:
   int m_sock;
   string m_sockPath;
   avro::EncoderPtr m_encoder;
-  std::ostringstream m_stringStream;
-  std::unique_ptr<avro::OutputStream> m_outStream;
+  std::vector<uint8_t> m_arena;
+  std::unique_ptr<BufferOutputStream> m_outStream;
+  std::vector<size_t> m_ends;
+  std::vector<struct mmsghdr> m_msgs;
+  std::vector<struct iovec> m_iovs;
+  size_t m_batchSize;
+  std::chrono::milliseconds m_batchLatency;
+  std::chrono::steady_clock::time_point m_batchStart;
+  uint64_t m_numBatches;
+  uint64_t m_numMsgs;
+  uint64_t m_numErrors;
   DEFINE_LOGGER();
+  void sendBatch();
+  inline void commitRecord() {
+    if (m_ends.empty() && m_batchSize > 1) {
+      m_batchStart = std::chrono::steady_clock::now();
+    }
+    m_ends.push_back(m_arena.size());
+    if (m_ends.size() >= m_batchSize) {
+      sendBatch();
+    }
+  }
+  inline avro::Encoder *beginRecord() { return m_encoder.get(); }
+  inline void endRecord() {
+    m_encoder->flush();
+    commitRecord();
+  }
 
 public:
   SFSocketWriter(context::SysFlowContext *cxt, time_t start);
@@ -48,18 +81,23 @@ public:
   inline void write(SysFlow *flow) {
     avro::encode(*m_encoder, *flow);
     m_encoder->flush();
-    if (send(m_sock, (const void *)m_stringStream.str().c_str(),
-             m_stringStream.str().size(), 0) < 0) {
-      SF_ERROR(m_logger, "Unable to send on domain socket:  "
-                             << m_sockPath
-                             << ". Error Code: " << std::strerror(errno));
-    }
-
-    m_stringStream.str("");
-    m_stringStream.clear();
+    commitRecord();
+  }
+  inline void writeEncoded(const uint8_t *data, size_t len) {
+    m_arena.insert(m_arena.end(), data, data + len);
+    commitRecord();
   }
   int initialize();
   void reset(time_t curTime);
+  void flush();
+  inline uint64_t getFlushInterval() {
+    if (m_batchSize <= 1) {
+      return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(m_batchLatency)
+        .count();
+  }
+  void printStats();
 };
 } // namespace writer
 #endif
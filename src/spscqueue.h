@@ -0,0 +1,155 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_SPSC_QUEUE_
+#define __SF_SPSC_QUEUE_
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define SPSC_CACHE_LINE 64
+#define SPSC_PARK_SPINS 128
+
+namespace writer {
+/**
+ * Spin, then yield, then sleep; used by pipeline stages waiting on an empty
+ * or full ring.
+ **/
+inline void backoff(int &spins) {
+  if (spins < 64) {
+    spins++;
+  } else if (spins < 128) {
+    spins++;
+    std::this_thread::yield();
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+}
+
+/**
+ * Bounded, lock-free, single producer/single consumer ring of preallocated
+ * slots. The producer fills a slot in place (acquire/commit) and the consumer
+ * drains it in place (peek/release), so slots (and any heap storage they own)
+ * are reused rather than reallocated for every element. An idle consumer
+ * parks on a condition variable instead of polling; the producer only takes
+ * the lock when it sees the consumer parked.
+ **/
+template <typename T> class SPSCQueue {
+private:
+  std::vector<T> m_slots;
+  size_t m_mask;
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> m_head;
+  size_t m_cachedTail;
+  alignas(SPSC_CACHE_LINE) std::atomic<size_t> m_tail;
+  size_t m_cachedHead;
+  std::atomic<bool> m_parked;
+  std::mutex m_lock;
+  std::condition_variable m_wake;
+
+  static size_t roundUp(size_t n) {
+    size_t cap = 2;
+    while (cap < n) {
+      cap <<= 1;
+    }
+    return cap;
+  }
+
+public:
+  explicit SPSCQueue(size_t capacity)
+      : m_slots(roundUp(capacity)), m_mask(m_slots.size() - 1), m_head(0),
+        m_cachedTail(0), m_tail(0), m_cachedHead(0), m_parked(false) {}
+
+  inline size_t capacity() const { return m_slots.size(); }
+
+  inline size_t size() const {
+    return m_tail.load(std::memory_order_acquire) -
+           m_head.load(std::memory_order_acquire);
+  }
+
+  // producer side: returns the next free slot or nullptr if the ring is full.
+  inline T *acquire() {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cachedHead == m_slots.size()) {
+      m_cachedHead = m_head.load(std::memory_order_acquire);
+      if (tail - m_cachedHead == m_slots.size()) {
+        return nullptr;
+      }
+    }
+    return &m_slots[tail & m_mask];
+  }
+
+  // producer side: publishes the slot returned by acquire().
+  inline void commit() {
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+    // pairs with the fence in park(): either the consumer sees the new tail
+    // or this sees it parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_parked.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_wake.notify_one();
+    }
+  }
+
+  // consumer side: returns the oldest published slot or nullptr if empty.
+  inline T *peek() {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cachedTail) {
+      m_cachedTail = m_tail.load(std::memory_order_acquire);
+      if (head == m_cachedTail) {
+        return nullptr;
+      }
+    }
+    return &m_slots[head & m_mask];
+  }
+
+  // consumer side: hands the slot returned by peek() back to the producer.
+  inline void release() {
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+  }
+
+  // consumer side: blocks until the producer commits or timeout passes.
+  void park(std::chrono::nanoseconds timeout) {
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_parked.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_tail.load(std::memory_order_relaxed) ==
+        m_head.load(std::memory_order_relaxed)) {
+      m_wake.wait_for(lk, timeout);
+    }
+    m_parked.store(false, std::memory_order_relaxed);
+  }
+
+  // consumer side: waits on an empty ring, spinning and yielding briefly
+  // before parking for up to timeout.
+  inline void wait(int &spins, std::chrono::nanoseconds timeout) {
+    if (spins < SPSC_PARK_SPINS) {
+      backoff(spins);
+    } else {
+      park(timeout);
+    }
+  }
+};
+} // namespace writer
+#endif
@@ -0,0 +1,89 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_SWEEP_CURSOR_
+#define __SF_SWEEP_CURSOR_
+#include <cstdint>
+
+namespace table {
+/**
+ * Resumable walk over a dense_hash_map that runs once per writer epoch, a
+ * batch at a time. The cursor rests on the last entry it handed out and
+ * advances before the next one; entries erased in between, by the walk or
+ * anyone else, are skipped by the table iterator. Inserts may rehash the
+ * table between batches; the cursor notices through the table's end() and
+ * starts the walk over, which is harmless as long as the work done on each
+ * entry is idempotent.
+ **/
+template <typename Table> class SweepCursor {
+private:
+  typename Table::iterator m_it;
+  typename Table::iterator m_end;
+  uint64_t m_epoch{0};
+  bool m_done{true};
+
+public:
+  // returns the next entry of the walk of this epoch, or table.end() once
+  // the walk has covered the table.
+  inline typename Table::iterator next(Table &table, uint64_t epoch) {
+    if (epoch != m_epoch) {
+      m_epoch = epoch;
+      m_done = false;
+      m_it = table.begin();
+    } else if (m_done) {
+      return table.end();
+    } else if (table.end() != m_end) {
+      m_it = table.begin();
+    } else {
+      ++m_it;
+    }
+    m_end = table.end();
+    m_done = (m_it == m_end);
+    return m_it;
+  }
+};
+
+/**
+ * Hand of a CLOCK cache over a dense_hash_map: cycles through the entries,
+ * wrapping around at the end. Like SweepCursor, it rests on the entry it
+ * handed out last, which may be erased before the next call, and starts
+ * over from the beginning after a rehash.
+ **/
+template <typename Table> class ClockHand {
+private:
+  typename Table::iterator m_it;
+  typename Table::iterator m_end;
+  bool m_started{false};
+
+public:
+  // returns the entry under the hand, or table.end() if the table is empty.
+  inline typename Table::iterator next(Table &table) {
+    if (!m_started || table.end() != m_end) {
+      m_started = true;
+      m_it = table.begin();
+    } else if (m_it == m_end || ++m_it == m_end) {
+      m_it = table.begin();
+    }
+    m_end = table.end();
+    return m_it;
+  }
+};
+} // namespace table
+
+#endif
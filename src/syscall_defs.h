@@ -29,10 +29,10 @@
   case PPME_SYSCALL_EXECVE_17_E:                                               \
   case PPME_SYSCALL_EXECVE_18_E:                                               \
   case PPME_SYSCALL_EXECVE_19_E: {                                             \
-    break;                                                                     \
+    return SF_DISPATCH(H_NONE, OP_EXEC);                                       \
   }
 
-#define SF_EXECVE_EXIT(EV)                                                     \
+#define SF_EXECVE_EXIT()                                                       \
   case PPME_SYSCALL_EXECVE_8_X:                                                \
   case PPME_SYSCALL_EXECVE_13_X:                                               \
   case PPME_SYSCALL_EXECVE_14_X:                                               \
@@ -41,11 +41,10 @@
   case PPME_SYSCALL_EXECVE_17_X:                                               \
   case PPME_SYSCALL_EXECVE_18_X:                                               \
   case PPME_SYSCALL_EXECVE_19_X: {                                             \
-    m_ctrlPrcr->handleProcEvent(EV, OP_EXEC);                                  \
-    break;                                                                     \
+    return SF_DISPATCH(H_PROC, OP_EXEC);                                       \
   }
 
-#define SF_CLONE_EXIT(EV)                                                      \
+#define SF_CLONE_EXIT()                                                        \
   case PPME_SYSCALL_CLONE_11_X:                                                \
   case PPME_SYSCALL_CLONE_16_X:                                                \
   case PPME_SYSCALL_CLONE_17_X:                                                \
@@ -56,38 +55,33 @@
   case PPME_SYSCALL_VFORK_17_X:                                                \
   case PPME_SYSCALL_FORK_20_X:                                                 \
   case PPME_SYSCALL_VFORK_20_X: {                                              \
-    m_ctrlPrcr->handleProcEvent(EV, OP_CLONE);                                 \
-    break;                                                                     \
+    return SF_DISPATCH(H_PROC, OP_CLONE);                                      \
   }
 
-#define SF_PROCEXIT_E_X(EV)                                                    \
+#define SF_PROCEXIT_E_X()                                                      \
   case PPME_PROCEXIT_E:                                                        \
   case PPME_PROCEXIT_X:                                                        \
   case PPME_PROCEXIT_1_E:                                                      \
   case PPME_PROCEXIT_1_X: {                                                    \
-    m_ctrlPrcr->handleProcEvent(EV, OP_EXIT);                                  \
-    break;                                                                     \
+    return SF_DISPATCH(H_PROC, OP_EXIT);                                       \
   }
 
-#define SF_OPEN_EXIT(EV)                                                       \
+#define SF_OPEN_EXIT()                                                         \
   case PPME_SYSCALL_OPEN_X:                                                    \
   case PPME_SYSCALL_OPENAT_X:                                                  \
   case PPME_SYSCALL_OPENAT_2_X:                                                \
   case PPME_SYSCALL_TIMERFD_CREATE_X: {                                        \
-    m_dfPrcr->handleDataEvent(EV, OP_OPEN);                                    \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_OPEN);                                       \
   }
 
-#define SF_CLOSE_EXIT(EV)                                                      \
+#define SF_CLOSE_EXIT()                                                        \
   case PPME_SYSCALL_CLOSE_X: {                                                 \
-    m_dfPrcr->handleDataEvent(EV, OP_CLOSE);                                   \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_CLOSE);                                      \
   }
 
-#define SF_SHUTDOWN_EXIT(EV)                                                   \
+#define SF_SHUTDOWN_EXIT()                                                     \
   case PPME_SOCKET_SHUTDOWN_X: {                                               \
-    m_dfPrcr->handleDataEvent(EV, OP_SHUTDOWN);                                \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_SHUTDOWN);                                   \
   }
 
 #define SF_READ_EXIT                                                           \
@@ -102,26 +96,24 @@
   case PPME_SYSCALL_PWRITEV_X:                                                 \
   case PPME_SYSCALL_PWRITE_X:
 
-#define SF_ACCEPT_EXIT(EV)                                                     \
+#define SF_ACCEPT_EXIT()                                                       \
   case PPME_SOCKET_ACCEPT_X:                                                   \
   case PPME_SOCKET_ACCEPT4_X:                                                  \
   case PPME_SOCKET_ACCEPT_5_X:                                                 \
   case PPME_SOCKET_ACCEPT4_5_X:                                                \
   case PPME_SYSCALL_SELECT_X:                                                  \
   case PPM_SC_PSELECT6: {                                                      \
-    m_dfPrcr->handleDataEvent(EV, OP_ACCEPT);                                  \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_ACCEPT);                                     \
   }
 
 #define SF_BIND_EXIT case PPME_SOCKET_BIND_X:
 
-#define SF_CONNECT_EXIT(EV)                                                    \
+#define SF_CONNECT_EXIT()                                                      \
   case PPME_SOCKET_CONNECT_X: {                                                \
-    m_dfPrcr->handleDataEvent(EV, OP_CONNECT);                                 \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_CONNECT);                                    \
   }
 
-#define SF_SEND_EXIT(EV)                                                       \
+#define SF_SEND_EXIT()                                                         \
   case PPME_SOCKET_SEND_X:                                                     \
   case PPME_SOCKET_SENDTO_X:                                                   \
   case PPME_SOCKET_SENDMSG_X:                                                  \
@@ -130,11 +122,10 @@
   case PPME_SYSCALL_PWRITEV_X:                                                 \
   case PPME_SYSCALL_PWRITE_X:                                                  \
   case PPME_SYSCALL_WRITE_X: {                                                 \
-    m_dfPrcr->handleDataEvent(EV, OP_WRITE_SEND);                              \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_WRITE_SEND);                                 \
   }
 
-#define SF_RECV_EXIT(EV)                                                       \
+#define SF_RECV_EXIT()                                                         \
   case PPME_SOCKET_RECV_X:                                                     \
   case PPME_SOCKET_RECVFROM_X:                                                 \
   case PPME_SOCKET_RECVMSG_X:                                                  \
@@ -143,71 +134,62 @@
   case PPME_SYSCALL_PREADV_X:                                                  \
   case PPME_SYSCALL_READV_X:                                                   \
   case PPME_SYSCALL_READ_X: {                                                  \
-    m_dfPrcr->handleDataEvent(EV, OP_READ_RECV);                               \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_READ_RECV);                                  \
   }
 
 #define SF_SOCKET_PAIR_EXIT case PPME_SOCKET_SOCKETPAIR_X:
 
-#define SF_MKDIR_EXIT(EV)                                                      \
+#define SF_MKDIR_EXIT()                                                        \
   case PPME_SYSCALL_MKDIR_X:                                                   \
   case PPME_SYSCALL_MKDIR_2_X:                                                 \
   case PPME_SYSCALL_MKDIRAT_X: {                                               \
-    m_dfPrcr->handleDataEvent(EV, OP_MKDIR);                                   \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_MKDIR);                                      \
   }
 
-#define SF_RMDIR_EXIT(EV)                                                      \
+#define SF_RMDIR_EXIT()                                                        \
   case PPME_SYSCALL_RMDIR_X:                                                   \
   case PPME_SYSCALL_RMDIR_2_X: {                                               \
-    m_dfPrcr->handleDataEvent(EV, OP_RMDIR);                                   \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_RMDIR);                                      \
   }
 
-#define SF_LINK_EXIT(EV)                                                       \
+#define SF_LINK_EXIT()                                                         \
   case PPME_SYSCALL_LINK_X:                                                    \
   case PPME_SYSCALL_LINK_2_X:                                                  \
   case PPME_SYSCALL_LINKAT_X:                                                  \
   case PPME_SYSCALL_LINKAT_2_X: {                                              \
-    m_dfPrcr->handleDataEvent(EV, OP_LINK);                                    \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_LINK);                                       \
   }
 
-#define SF_UNLINK_EXIT(EV)                                                     \
+#define SF_UNLINK_EXIT()                                                       \
   case PPME_SYSCALL_UNLINK_X:                                                  \
   case PPME_SYSCALL_UNLINK_2_X:                                                \
   case PPME_SYSCALL_UNLINKAT_X:                                                \
   case PPME_SYSCALL_UNLINKAT_2_X: {                                            \
-    m_dfPrcr->handleDataEvent(EV, OP_UNLINK);                                  \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_UNLINK);                                     \
   }
 
-#define SF_RENAME_EXIT(EV)                                                     \
+#define SF_RENAME_EXIT()                                                       \
   case PPME_SYSCALL_RENAME_X:                                                  \
   case PPME_SYSCALL_RENAMEAT_X: {                                              \
-    m_dfPrcr->handleDataEvent(EV, OP_RENAME);                                  \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_RENAME);                                     \
   }
 
-#define SF_SYMLINK_EXIT(EV)                                                    \
+#define SF_SYMLINK_EXIT()                                                      \
   case PPME_SYSCALL_SYMLINK_X:                                                 \
   case PPME_SYSCALL_SYMLINKAT_X: {                                             \
-    m_dfPrcr->handleDataEvent(EV, OP_SYMLINK);                                 \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_SYMLINK);                                    \
   }
 
-#define SF_SETUID_ENTER(EV)                                                    \
+#define SF_SETUID_ENTER()                                                      \
   case PPME_SYSCALL_SETUID_E:                                                  \
   case PPME_SYSCALL_SETRESUID_E: {                                             \
-    m_ctrlPrcr->setUID(EV);                                                    \
-    break;                                                                     \
+    return SF_DISPATCH(H_SETUID, OP_SETUID);                                   \
   }
 
-#define SF_SETUID_EXIT(EV)                                                     \
+#define SF_SETUID_EXIT()                                                       \
   case PPME_SYSCALL_SETUID_X:                                                  \
   case PPME_SYSCALL_SETRESUID_X: {                                             \
-    m_ctrlPrcr->handleProcEvent(EV, OP_SETUID);                                \
-    break;                                                                     \
+    return SF_DISPATCH(H_PROC, OP_SETUID);                                     \
   }
 
 #define SF_CHMOD_EXIT(EV)                                                      \
@@ -216,17 +198,15 @@
     break;                                                                     \
   }
 
-#define SF_SETNS_EXIT(EV)                                                      \
+#define SF_SETNS_EXIT()                                                        \
   case PPME_SYSCALL_SETNS_X: {                                                 \
-    m_dfPrcr->handleDataEvent(EV, OP_SETNS);                                   \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_SETNS);                                      \
   }
 
-#define SF_MMAP_EXIT(EV)                                                       \
+#define SF_MMAP_EXIT()                                                         \
   case PPME_SYSCALL_MMAP_E:                                                    \
   case PPME_SYSCALL_MMAP2_E: {                                                 \
-    m_dfPrcr->handleDataEvent(EV, OP_MMAP);                                    \
-    break;                                                                     \
+    return SF_DISPATCH(H_DATA, OP_MMAP);                                       \
   }
 
 #define IS_AT_SC(TYPE)                                                         \
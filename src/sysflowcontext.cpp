@@ -18,6 +18,7 @@
  **/
 
 #include "sysflowcontext.h"
+#include "sfcodec.h"
 #include <utility>
 
 using context::SysFlowContext;
@@ -34,7 +35,17 @@ SysFlowContext::SysFlowContext(bool fCont, int fDur, string oFile,
       m_nfExpireInterval(60), m_offline(false), m_filter(std::move(filter)),
       m_criPath(std::move(criPath)), m_criTO(criTO), m_stats(false),
       m_statsInterval(30), m_domainSock(false), m_processFlow(false),
-      m_fileOnly(false), m_fileRead(0), m_nodeIP() {
+      m_fileOnly(false), m_fileRead(0), m_nodeIP(), m_pipeline(false),
+      m_pipelineQueueSize(DEFAULT_PIPELINE_QUEUE_SIZE), m_asyncWriter(false),
+      m_asyncWriterBuffers(DEFAULT_ASYNC_WRITER_BUFFERS),
+      m_compressCodec(CODEC_DEFLATE),
+      m_compressBlockSize(DEFAULT_COMPRESS_BLOCK_SIZE),
+      m_compressLevel(CODEC_DEFAULT_LEVEL),
+      m_sockBatchSize(DEFAULT_SOCK_BATCH_SIZE),
+      m_sockBatchLatency(DEFAULT_SOCK_BATCH_LATENCY_MS),
+      m_syscallPruning(false), m_pathCache(nullptr), m_nameCache(nullptr),
+      m_exeArgsMaxBytes(DEFAULT_EXE_ARGS_MAX_BYTES),
+      m_fileCacheMaxBytes(DEFAULT_FILE_CACHE_MAX_BYTES) {
   m_inspector = new sinsp();
   m_inspector->set_hostname_and_port_resolution_mode(false);
   if (!m_filter.empty()) {
@@ -74,6 +85,96 @@ SysFlowContext::SysFlowContext(bool fCont, int fDur, string oFile,
     m_processFlow = true;
   }
 
+  const char *pipeline = std::getenv(ENABLE_PIPELINE);
+  if (pipeline != nullptr && strcmp(pipeline, "1") == 0) {
+    std::cout << "Enabled pipeline mode!" << std::endl;
+    m_pipeline = true;
+  }
+
+  const char *queueSize = std::getenv(PIPELINE_QUEUE_SIZE);
+  if (queueSize != nullptr && std::strlen(queueSize) > 0) {
+    int size = std::atoi(queueSize);
+    if (size > 0) {
+      m_pipelineQueueSize = size;
+    } else {
+      SF_WARN(m_logger, "PIPELINE_QUEUE_SIZE must be a positive number of "
+                        "records. Using default: "
+                            << DEFAULT_PIPELINE_QUEUE_SIZE)
+    }
+  }
+
+  const char *asyncWriter = std::getenv(ENABLE_ASYNC_WRITER);
+  if (asyncWriter != nullptr && strcmp(asyncWriter, "1") == 0) {
+    std::cout << "Enabled asynchronous file writer!" << std::endl;
+    m_asyncWriter = true;
+  }
+
+  const char *buffers = std::getenv(ASYNC_WRITER_BUFFERS);
+  if (buffers != nullptr && std::strlen(buffers) > 0) {
+    int num = std::atoi(buffers);
+    if (num >= 2) {
+      m_asyncWriterBuffers = num;
+    } else {
+      SF_WARN(m_logger, "ASYNC_WRITER_BUFFERS must be at least 2. Using "
+                        "default: "
+                            << DEFAULT_ASYNC_WRITER_BUFFERS)
+    }
+  }
+
+  const char *codec = std::getenv(COMPRESS_CODEC);
+  if (codec != nullptr && std::strlen(codec) > 0) {
+    string c(codec);
+    if (c == CODEC_NULL || c == CODEC_DEFLATE || c == CODEC_SNAPPY ||
+        c == CODEC_ZSTD || c == CODEC_ZSTANDARD) {
+      std::cout << "Using compression codec: " << c << std::endl;
+      m_compressCodec = c;
+    } else {
+      SF_WARN(m_logger, "Unsupported COMPRESS_CODEC " << c << ". Using default: "
+                                                       << CODEC_DEFLATE)
+    }
+  }
+
+  const char *blockSize = std::getenv(COMPRESS_BLOCK_SIZE);
+  if (blockSize != nullptr && std::strlen(blockSize) > 0) {
+    int size = std::atoi(blockSize);
+    if (size > 0) {
+      m_compressBlockSize = size;
+    } else {
+      SF_WARN(m_logger, "COMPRESS_BLOCK_SIZE must be a positive number of "
+                        "bytes. Using default: "
+                            << DEFAULT_COMPRESS_BLOCK_SIZE)
+    }
+  }
+
+  const char *level = std::getenv(COMPRESS_LEVEL);
+  if (level != nullptr && std::strlen(level) > 0) {
+    m_compressLevel = std::atoi(level);
+  }
+
+  const char *batchSize = std::getenv(SOCK_BATCH_SIZE);
+  if (batchSize != nullptr && std::strlen(batchSize) > 0) {
+    int size = std::atoi(batchSize);
+    if (size > 0) {
+      m_sockBatchSize = size;
+    } else {
+      SF_WARN(m_logger, "SOCK_BATCH_SIZE must be a positive number of "
+                        "records. Using default: "
+                            << DEFAULT_SOCK_BATCH_SIZE)
+    }
+  }
+
+  const char *batchLatency = std::getenv(SOCK_BATCH_LATENCY_MS);
+  if (batchLatency != nullptr && std::strlen(batchLatency) > 0) {
+    int latency = std::atoi(batchLatency);
+    if (latency >= 0) {
+      m_sockBatchLatency = latency;
+    } else {
+      SF_WARN(m_logger, "SOCK_BATCH_LATENCY_MS must not be negative. Using "
+                        "default: "
+                            << DEFAULT_SOCK_BATCH_LATENCY_MS)
+    }
+  }
+
   const char *fileRead = std::getenv(FILE_READ_MODE);
   if (fileRead == nullptr || strcmp(fileRead, "0") == 0) {
     std::cout << "Enabled all file reads!" << std::endl;
@@ -92,6 +193,72 @@ SysFlowContext::SysFlowContext(bool fCont, int fDur, string oFile,
         "FILE_READ_MODE must be set to 0 = enable all file reads, 1 = disable "
         "all file reads, or 2 = disable file reads to certain directories")
   }
+  const char *pruning = std::getenv(ENABLE_SYSCALL_PRUNING);
+  if (pruning != nullptr && strcmp(pruning, "1") == 0) {
+    if (m_scapFile.empty()) {
+      std::cout << "Enabled syscall pruning!" << std::endl;
+      m_syscallPruning = true;
+    } else {
+      SF_WARN(m_logger, "ENABLE_SYSCALL_PRUNING only applies to live "
+                        "captures. Ignoring it for trace file: "
+                            << m_scapFile)
+    }
+  }
+  int pathCacheSize = DEFAULT_PATH_CACHE_SIZE;
+  const char *cacheSize = std::getenv(PATH_CACHE_SIZE);
+  if (cacheSize != nullptr && std::strlen(cacheSize) > 0) {
+    int size = std::atoi(cacheSize);
+    if (size >= 0) {
+      pathCacheSize = size;
+    } else {
+      SF_WARN(m_logger, "PATH_CACHE_SIZE must be zero or a positive number of "
+                        "entries. Using default: "
+                            << DEFAULT_PATH_CACHE_SIZE)
+    }
+  }
+  bool resolveLinks = false;
+  const char *symlinks = std::getenv(RESOLVE_SYMLINKS);
+  if (symlinks != nullptr && strcmp(symlinks, "1") == 0) {
+    std::cout << "Enabled symlink resolution of file paths!" << std::endl;
+    resolveLinks = true;
+  }
+  m_pathCache = new pathcache::PathCache(pathCacheSize, resolveLinks,
+                                         DEFAULT_SYMLINK_BUDGET);
+  int nameTTL = DEFAULT_NAME_CACHE_TTL;
+  const char *ttl = std::getenv(NAME_CACHE_TTL);
+  if (ttl != nullptr && std::strlen(ttl) > 0) {
+    int secs = std::atoi(ttl);
+    if (secs > 0) {
+      nameTTL = secs;
+    } else {
+      SF_WARN(m_logger, "NAME_CACHE_TTL must be a positive number of seconds. "
+                        "Using default: "
+                            << DEFAULT_NAME_CACHE_TTL)
+    }
+  }
+  m_nameCache = new namecache::NameCache(m_inspector, nameTTL);
+  const char *argsMax = std::getenv(EXE_ARGS_MAX_BYTES);
+  if (argsMax != nullptr && std::strlen(argsMax) > 0) {
+    int bytes = std::atoi(argsMax);
+    if (bytes >= 0) {
+      m_exeArgsMaxBytes = bytes;
+    } else {
+      SF_WARN(m_logger, "EXE_ARGS_MAX_BYTES must be zero (no limit) or a "
+                        "positive number of bytes. Using default: "
+                            << DEFAULT_EXE_ARGS_MAX_BYTES)
+    }
+  }
+  const char *fileCacheMax = std::getenv(FILE_CACHE_MAX_BYTES);
+  if (fileCacheMax != nullptr && std::strlen(fileCacheMax) > 0) {
+    long long bytes = std::atoll(fileCacheMax);
+    if (bytes >= 0) {
+      m_fileCacheMaxBytes = bytes;
+    } else {
+      SF_WARN(m_logger, "FILE_CACHE_MAX_BYTES must be zero (no limit) or a "
+                        "positive number of bytes. Using default: "
+                            << DEFAULT_FILE_CACHE_MAX_BYTES)
+    }
+  }
   if (m_scapFile.empty()) {
     m_inspector->set_snaplen(0);
   }
@@ -104,6 +271,8 @@ SysFlowContext::~SysFlowContext() {
     m_inspector->close();
     delete m_inspector;
   }
+  delete m_pathCache;
+  delete m_nameCache;
 }
 string SysFlowContext::getExporterID() {
   if (m_exporterID.empty()) {
@@ -126,3 +295,10 @@ string SysFlowContext::getExporterID() {
 }
 
 string SysFlowContext::getNodeIP() { return m_nodeIP; }
+
+bool SysFlowContext::hasAvroCodec() {
+  // snappy support in avro c++ depends on how it was built, so only null and
+  // deflate at the default level go through avro::DataFileWriter.
+  return m_compressLevel == CODEC_DEFAULT_LEVEL &&
+         (m_compressCodec == CODEC_NULL || m_compressCodec == CODEC_DEFLATE);
+}
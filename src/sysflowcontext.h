@@ -24,9 +24,12 @@
 #include <ctime>
 
 #include "logger.h"
+#include "namecache.h"
+#include "pathcache.h"
 #include "readonly.h"
 #include <cerrno>
 #include <cstdlib>
+#include <chrono>
 #include <cstring>
 #include <sinsp.h>
 #include <unistd.h>
@@ -37,6 +40,25 @@
 #define FILE_READ_MODE "FILE_READ_MODE"
 #define FILE_ONLY "FILE_ONLY"
 #define ENABLE_PROC_FLOW "ENABLE_PROC_FLOW"
+#define ENABLE_PIPELINE "ENABLE_PIPELINE"
+#define PIPELINE_QUEUE_SIZE "PIPELINE_QUEUE_SIZE"
+#define DEFAULT_PIPELINE_QUEUE_SIZE 16384
+#define ENABLE_ASYNC_WRITER "ENABLE_ASYNC_WRITER"
+#define ASYNC_WRITER_BUFFERS "ASYNC_WRITER_BUFFERS"
+#define DEFAULT_ASYNC_WRITER_BUFFERS 2
+#define COMPRESS_CODEC "COMPRESS_CODEC"
+#define COMPRESS_BLOCK_SIZE "COMPRESS_BLOCK_SIZE"
+#define COMPRESS_LEVEL "COMPRESS_LEVEL"
+#define DEFAULT_COMPRESS_BLOCK_SIZE 80000
+#define SOCK_BATCH_SIZE "SOCK_BATCH_SIZE"
+#define SOCK_BATCH_LATENCY_MS "SOCK_BATCH_LATENCY_MS"
+#define DEFAULT_SOCK_BATCH_SIZE 1
+#define DEFAULT_SOCK_BATCH_LATENCY_MS 50
+#define ENABLE_SYSCALL_PRUNING "ENABLE_SYSCALL_PRUNING"
+#define EXE_ARGS_MAX_BYTES "EXE_ARGS_MAX_BYTES"
+#define DEFAULT_EXE_ARGS_MAX_BYTES 4096
+#define FILE_CACHE_MAX_BYTES "FILE_CACHE_MAX_BYTES"
+#define DEFAULT_FILE_CACHE_MAX_BYTES 67108864
 
 namespace context {
 class SysFlowContext {
@@ -63,6 +85,20 @@ private:
   bool m_fileOnly;
   int m_fileRead;
   string m_nodeIP;
+  bool m_pipeline;
+  int m_pipelineQueueSize;
+  bool m_asyncWriter;
+  int m_asyncWriterBuffers;
+  string m_compressCodec;
+  int m_compressBlockSize;
+  int m_compressLevel;
+  int m_sockBatchSize;
+  int m_sockBatchLatency;
+  bool m_syscallPruning;
+  pathcache::PathCache *m_pathCache;
+  namecache::NameCache *m_nameCache;
+  int m_exeArgsMaxBytes;
+  size_t m_fileCacheMaxBytes;
   DEFINE_LOGGER();
 
 public:
@@ -90,6 +126,23 @@ public:
   inline int getStatsInterval() { return m_statsInterval; }
   inline bool isFileOnly() { return m_fileOnly; }
   inline int getFileRead() { return m_fileRead; }
+  inline bool isPipelineEnabled() { return m_pipeline; }
+  inline int getPipelineQueueSize() { return m_pipelineQueueSize; }
+  inline bool isAsyncWriterEnabled() { return m_asyncWriter; }
+  inline int getAsyncWriterBuffers() { return m_asyncWriterBuffers; }
+  inline string getCompressCodec() { return m_compressCodec; }
+  inline int getCompressBlockSize() { return m_compressBlockSize; }
+  inline int getCompressLevel() { return m_compressLevel; }
+  bool hasAvroCodec();
+  inline int getSockBatchSize() { return m_sockBatchSize; }
+  inline std::chrono::milliseconds getSockBatchLatency() {
+    return std::chrono::milliseconds(m_sockBatchLatency);
+  }
+  inline bool isSyscallPruningEnabled() { return m_syscallPruning; }
+  inline pathcache::PathCache *getPathCache() { return m_pathCache; }
+  inline namecache::NameCache *getNameCache() { return m_nameCache; }
+  inline size_t getExeArgsMaxBytes() { return m_exeArgsMaxBytes; }
+  inline size_t getFileCacheMaxBytes() { return m_fileCacheMaxBytes; }
 };
 } // namespace context
 
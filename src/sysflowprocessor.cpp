@@ -24,7 +24,9 @@ using sysflowprocessor::SysFlowProcessor;
 CREATE_LOGGER(SysFlowProcessor, "sysflow.sysflowprocessor");
 
 SysFlowProcessor::SysFlowProcessor(context::SysFlowContext *cxt)
-    : m_exit(false) {
+    : m_exit(false), m_nextHousekeeping(0), m_nextFlush(0),
+      m_flushInterval(0), m_numEvents(0), m_numDispatched(0),
+      m_statsEvents(0) {
   m_cxt = cxt;
   time_t start = 0;
   if (m_cxt->getFileDuration() > 0) {
@@ -35,19 +37,40 @@ SysFlowProcessor::SysFlowProcessor(context::SysFlowContext *cxt)
   } else {
     m_statsTime = 0;
   }
-  if (!m_cxt->isDomainSock()) {
+  if (!m_cxt->isDomainSock() &&
+      (m_cxt->isAsyncWriterEnabled() || !m_cxt->hasAvroCodec())) {
+    m_writer = new writer::SFAsyncFileWriter(cxt, start);
+  } else if (!m_cxt->isDomainSock()) {
     m_writer = new writer::SFFileWriter(cxt, start);
   } else {
     m_writer = new writer::SFSocketWriter(cxt, start);
   }
+  if (m_cxt->isPipelineEnabled()) {
+    m_writer = new writer::SFPipelineWriter(cxt, start, m_writer);
+  }
+  m_flushInterval = m_writer->getFlushInterval();
   m_containerCxt = new container::ContainerContext(m_cxt, m_writer);
-  m_fileCxt = new file::FileContext(m_containerCxt, m_writer);
+  m_fileCxt = new file::FileContext(m_cxt, m_containerCxt, m_writer);
   m_processCxt =
       new process::ProcessContext(m_cxt, m_containerCxt, m_fileCxt, m_writer);
   m_dfPrcr =
       new dataflow::DataFlowProcessor(m_cxt, m_writer, m_processCxt, m_fileCxt);
   m_ctrlPrcr = new controlflow::ControlFlowProcessor(m_cxt, m_writer,
                                                      m_processCxt, m_dfPrcr);
+  if (m_cxt->isSyscallPruningEnabled()) {
+    try {
+      int pruned = m_dispatch.prune(m_cxt->getInspector());
+      SF_INFO(m_logger, "Syscall pruning: masked "
+                            << pruned << " of " << PPM_EVENT_MAX
+                            << " event types in the driver. Handled: "
+                            << m_dispatch.getNumHandled() << " Required: "
+                            << m_dispatch.getNumRequired());
+    } catch (sinsp_exception &e) {
+      SF_WARN(m_logger, "Unable to prune syscalls in the driver, capturing "
+                        "all events: "
+                            << e.what());
+    }
+  }
 }
 
 SysFlowProcessor::~SysFlowProcessor() {
@@ -60,10 +83,16 @@ SysFlowProcessor::~SysFlowProcessor() {
   delete m_cxt;
 }
 
-void SysFlowProcessor::clearTables() {
-  m_processCxt->clearProcesses();
-  m_containerCxt->clearContainers();
-  m_fileCxt->clearFiles();
+// A rotation only moves the writer to a new epoch. Objects not written in it
+// and no longer referenced are evicted here, a batch per table and tick, so
+// rotating never stalls the event loop on a full table walk. Processes go
+// first since evicting them drops container references. The file table is
+// also held to its memory budget here.
+void SysFlowProcessor::sweepTables() {
+  m_processCxt->sweep(SWEEP_BATCH_SIZE);
+  m_fileCxt->sweep(SWEEP_BATCH_SIZE);
+  m_fileCxt->evict();
+  m_containerCxt->sweep(SWEEP_BATCH_SIZE);
 }
 
 bool SysFlowProcessor::checkAndRotateFile() {
@@ -78,14 +107,22 @@ bool SysFlowProcessor::checkAndRotateFile() {
                 << " FileFlow Table: " << m_dfPrcr->getFFSize()
                 << " ProcFlow Table: " << m_ctrlPrcr->getSize()
                 << " Num Records Written: " << m_writer->getNumRecs());
-    m_writer->reset(curTime);
-    clearTables();
+    m_writer->rotate(curTime);
     fileRotated = true;
   }
   if (m_statsTime > 0) {
     double duration = difftime(curTime, m_statsTime);
     if (duration >= m_cxt->getStatsInterval()) {
+      SF_INFO(m_logger, "Events: " << m_numEvents
+                                   << " Dispatched: " << m_numDispatched
+                                   << " Events/sec: "
+                                   << (m_numEvents - m_statsEvents) / duration);
+      m_statsEvents = m_numEvents;
       m_dfPrcr->printFlowStats();
+      m_cxt->getPathCache()->printStats();
+      m_cxt->getNameCache()->printStats();
+      m_fileCxt->printStats();
+      m_writer->printStats();
       m_statsTime = curTime;
     }
   }
@@ -104,6 +141,18 @@ int SysFlowProcessor::checkForExpiredRecords() {
   return numExpired + numProcExpired;
 }
 
+// Expiry, deletion, rotation and stats all work on whole seconds of
+// getCurrentTime(), so their outcome can only change once the event clock
+// enters a new second. Running them on the first event of each second is
+// equivalent to running them on every event, for live and -r replays alike.
+void SysFlowProcessor::runHousekeeping(uint64_t ts) {
+  checkForExpiredRecords();
+  m_processCxt->checkForDeletion();
+  checkAndRotateFile();
+  sweepTables();
+  m_nextHousekeeping = (ts / NANO_TO_SECS + 1) * NANO_TO_SECS;
+}
+
 int SysFlowProcessor::run() {
   int32_t res = 0;
   sinsp_evt *ev = nullptr;
@@ -115,9 +164,8 @@ int SysFlowProcessor::run() {
         if (m_exit) {
           break;
         }
-        checkForExpiredRecords();
-        m_processCxt->checkForDeletion();
-        checkAndRotateFile();
+        runHousekeeping(utils::getSysdigTime(m_cxt));
+        m_writer->flush();
         continue;
       } else if (res == SCAP_EOF) {
         break;
@@ -131,34 +179,36 @@ int SysFlowProcessor::run() {
       if (m_exit) {
         break;
       }
-      checkForExpiredRecords();
-      m_processCxt->checkForDeletion();
-      checkAndRotateFile();
+      if (m_cxt->timeStamp >= m_nextHousekeeping) {
+        runHousekeeping(m_cxt->timeStamp);
+      }
+      // writers holding records back get a chance to send them once per
+      // flush interval of event time, not on every event.
+      if (m_flushInterval > 0 && m_cxt->timeStamp >= m_nextFlush) {
+        m_writer->flush();
+        m_nextFlush = m_cxt->timeStamp + m_flushInterval;
+      }
+      m_numEvents++;
+      const dispatch::Entry &de = m_dispatch.lookup(ev->get_type());
+      if (de.handler == dispatch::H_NONE) {
+        continue;
+      }
       if (m_cxt->isFilterContainers() && !utils::isInContainer(ev)) {
         continue;
       }
-      switch (ev->get_type()) {
-        SF_EXECVE_ENTER()
-        SF_EXECVE_EXIT(ev)
-        SF_CLONE_EXIT(ev)
-        SF_PROCEXIT_E_X(ev)
-        SF_OPEN_EXIT(ev)
-        SF_ACCEPT_EXIT(ev)
-        SF_CONNECT_EXIT(ev)
-        SF_SEND_EXIT(ev)
-        SF_RECV_EXIT(ev)
-        SF_CLOSE_EXIT(ev)
-        SF_SETNS_EXIT(ev)
-        SF_MKDIR_EXIT(ev)
-        SF_RMDIR_EXIT(ev)
-        SF_LINK_EXIT(ev)
-        SF_UNLINK_EXIT(ev)
-        SF_SYMLINK_EXIT(ev)
-        SF_RENAME_EXIT(ev)
-        SF_SETUID_ENTER(ev)
-        SF_SETUID_EXIT(ev)
-        SF_SHUTDOWN_EXIT(ev)
-        SF_MMAP_EXIT(ev)
+      m_numDispatched++;
+      switch (de.handler) {
+      case dispatch::H_PROC:
+        m_ctrlPrcr->handleProcEvent(ev, de.flag);
+        break;
+      case dispatch::H_DATA:
+        m_dfPrcr->handleDataEvent(ev, de.flag);
+        break;
+      case dispatch::H_SETUID:
+        m_ctrlPrcr->setUID(ev);
+        break;
+      default:
+        break;
       }
     }
     SF_INFO(m_logger, "Exiting scap loop... shutting down");
@@ -22,16 +22,22 @@
 #include "containercontext.h"
 #include "controlflowprocessor.h"
 #include "dataflowprocessor.h"
+#include "eventdispatch.h"
 #include "filecontext.h"
 #include "logger.h"
 #include "processcontext.h"
+#include "sfasyncfilewriter.h"
 #include "sffilewriter.h"
+#include "sfpipelinewriter.h"
 #include "sfsockwriter.h"
-#include "syscall_defs.h"
 #include "sysflowcontext.h"
 #include <ctime>
 #include <string>
 
+#define NANO_TO_SECS 1000000000
+// table entries each context sweep looks at per housekeeping tick.
+#define SWEEP_BATCH_SIZE 16384
+
 namespace sysflowprocessor {
 class SysFlowProcessor {
 public:
@@ -50,10 +56,18 @@ private:
   process::ProcessContext *m_processCxt;
   controlflow::ControlFlowProcessor *m_ctrlPrcr;
   dataflow::DataFlowProcessor *m_dfPrcr;
-  void clearTables();
+  dispatch::EventDispatchTable m_dispatch;
+  void sweepTables();
   int checkForExpiredRecords();
   bool checkAndRotateFile();
+  void runHousekeeping(uint64_t ts);
   time_t m_statsTime;
+  uint64_t m_nextHousekeeping;
+  uint64_t m_nextFlush;
+  uint64_t m_flushInterval;
+  uint64_t m_numEvents;
+  uint64_t m_numDispatched;
+  uint64_t m_statsEvents;
 };
 } // namespace sysflowprocessor
 
@@ -26,6 +26,25 @@ SysFlowWriter::SysFlowWriter(context::SysFlowContext *cxt, time_t start)
   m_cxt = cxt;
   m_start = start;
   m_version = utils::getSchemaVersion();
+  // union branch indexes follow the schema, so look them up rather than
+  // hardcoding them.
+  decltype(m_flow.rec) rec;
+  rec.set_Container(Container());
+  m_contIdx = rec.idx();
+  rec.set_Process(Process());
+  m_procIdx = rec.idx();
+  rec.set_File(File());
+  m_fileIdx = rec.idx();
+  rec.set_ProcessEvent(ProcessEvent());
+  m_peIdx = rec.idx();
+  rec.set_NetworkFlow(NetworkFlow());
+  m_nfIdx = rec.idx();
+  rec.set_FileFlow(FileFlow());
+  m_ffIdx = rec.idx();
+  rec.set_FileEvent(FileEvent());
+  m_feIdx = rec.idx();
+  rec.set_ProcessFlow(ProcessFlow());
+  m_pfIdx = rec.idx();
 }
 
 void SysFlowWriter::writeHeader() {
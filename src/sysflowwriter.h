@@ -19,6 +19,8 @@
 
 #ifndef __SF_WRITER_
 #define __SF_WRITER_
+#include "avro/Encoder.hh"
+#include "avro/Specific.hh"
 #include "op_flags.h"
 #include "sysflow.h"
 #include "sysflowcontext.h"
@@ -43,60 +45,101 @@ protected:
   void writeHeader();
   time_t m_start;
   int64_t m_version;
+  size_t m_contIdx;
+  size_t m_procIdx;
+  size_t m_fileIdx;
+  size_t m_peIdx;
+  size_t m_nfIdx;
+  size_t m_ffIdx;
+  size_t m_feIdx;
+  size_t m_pfIdx;
+  uint64_t m_epoch{1};
   virtual void write(SysFlow *flow) = 0;
+  // returns the encoder positioned at the next record, or nullptr if the
+  // writer needs a SysFlow object (e.g., to hand it to another thread).
+  virtual avro::Encoder *beginRecord() { return nullptr; }
+  virtual void endRecord() {}
+  // encodes a SysFlow record straight from the live object, without copying
+  // it into the SysFlow union. The bytes are the same as encoding the union.
+  template <typename T> inline bool encodeDirect(size_t idx, const T &rec) {
+    avro::Encoder *enc = beginRecord();
+    if (enc == nullptr) {
+      return false;
+    }
+    enc->encodeUnionIndex(idx);
+    avro::encode(*enc, rec);
+    endRecord();
+    return true;
+  }
 
 public:
   SysFlowWriter(context::SysFlowContext *cxt, time_t start);
   virtual ~SysFlowWriter() {}
   inline int getNumRecs() { return m_numRecs; }
   inline void writeContainer(Container *container) {
-    m_flow.rec.set_Container(*container);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_contIdx, *container)) {
+      m_flow.rec.set_Container(*container);
+      write(&m_flow);
+    }
   }
   inline void writeProcess(Process *proc) {
-    m_flow.rec.set_Process(*proc);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_procIdx, *proc)) {
+      m_flow.rec.set_Process(*proc);
+      write(&m_flow);
+    }
   }
   inline void writeProcessEvent(ProcessEvent *pe) {
-    m_flow.rec.set_ProcessEvent(*pe);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_peIdx, *pe)) {
+      m_flow.rec.set_ProcessEvent(*pe);
+      write(&m_flow);
+    }
   }
   inline void writeNetFlow(NetworkFlow *nf) {
     if (nf->opFlags == 0 || nf->opFlags == OP_TRUNCATE) {
       return;
     }
-    m_flow.rec.set_NetworkFlow(*nf);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_nfIdx, *nf)) {
+      m_flow.rec.set_NetworkFlow(*nf);
+      write(&m_flow);
+    }
   }
   inline void writeProcessFlow(ProcessFlow *pf) {
     if (pf->opFlags == 0 || pf->opFlags == OP_TRUNCATE) {
       return;
     }
-    m_flow.rec.set_ProcessFlow(*pf);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_pfIdx, *pf)) {
+      m_flow.rec.set_ProcessFlow(*pf);
+      write(&m_flow);
+    }
   }
   inline void writeFileFlow(FileFlow *ff) {
     if (ff->opFlags == 0 || ff->opFlags == OP_TRUNCATE) {
       return;
     }
-    m_flow.rec.set_FileFlow(*ff);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_ffIdx, *ff)) {
+      m_flow.rec.set_FileFlow(*ff);
+      write(&m_flow);
+    }
   }
   inline void writeFileEvent(FileEvent *fe) {
-    m_flow.rec.set_FileEvent(*fe);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_feIdx, *fe)) {
+      m_flow.rec.set_FileEvent(*fe);
+      write(&m_flow);
+    }
   }
   inline void writeFile(sysflow::File *f) {
-    m_flow.rec.set_File(*f);
     m_numRecs++;
-    write(&m_flow);
+    if (!encodeDirect(m_fileIdx, *f)) {
+      m_flow.rec.set_File(*f);
+      write(&m_flow);
+    }
   }
   inline bool isExpired(time_t curTime) {
     if (m_start > 0) {
@@ -110,6 +153,22 @@ public:
   }
   virtual int initialize() = 0;
   virtual void reset(time_t curTime) = 0;
+  // file epoch: moves on every time the writer starts a new file. Objects
+  // keep the epoch their record was last written in, so a rotation marks
+  // all of them unwritten at once.
+  inline uint64_t getEpoch() { return m_epoch; }
+  inline void rotate(time_t curTime) {
+    reset(curTime);
+    m_epoch++;
+  }
+  // writes a record already serialized with the avro binary encoder.
+  virtual void writeEncoded(const uint8_t *data, size_t len) = 0;
+  // sends out records held back by writers that batch their output.
+  virtual void flush() {}
+  // event time, in nanoseconds, flush() may be left alone for; 0 if the
+  // writer holds nothing back.
+  virtual uint64_t getFlushInterval() { return 0; }
+  virtual void printStats() {}
 };
 } // namespace writer
 #endif
@@ -0,0 +1,244 @@
+/** Copyright (C) 2019 IBM Corporation.
+ *
+ * Authors:
+ * Frederico Araujo <frederico.araujo@ibm.com>
+ * Teryl Taylor <terylt@ibm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __SF_TIMER_WHEEL_
+#define __SF_TIMER_WHEEL_
+#include <cstddef>
+#include <ctime>
+
+#define TW_LEVEL_BITS 6
+#define TW_SLOTS (1 << TW_LEVEL_BITS)
+#define TW_SLOT_MASK (TW_SLOTS - 1)
+#define TW_LEVELS 4
+
+namespace timer {
+/**
+ * Intrusive hook for objects scheduled on a TimerWheel. A node is armed
+ * while it is linked into one of the wheel's slots or into its due list.
+ **/
+class TimerNode {
+public:
+  TimerNode *prev{nullptr};
+  TimerNode *next{nullptr};
+  time_t deadline{0};
+  inline bool isArmed() const { return next != nullptr; }
+};
+
+/**
+ * Hierarchical timing wheel with one second ticks. Level 0 holds deadlines
+ * within the next 64 seconds, and each further level covers 64 times the
+ * range of the previous one; entries cascade down as the wheel turns.
+ * Schedule, cancel and re-arm are O(1). Entries sharing a deadline expire in
+ * the order they were scheduled: an entry cascading down was scheduled
+ * before any entry placed directly at the lower level with its deadline, so
+ * cascades put entries ahead of those already in the target slot. Turning
+ * the wheel skips ticks that would find nothing to do.
+ **/
+template <typename T> class TimerWheel {
+private:
+  TimerNode m_slots[TW_LEVELS][TW_SLOTS];
+  TimerNode m_due;
+  time_t m_now;
+  size_t m_size;
+  bool m_started;
+
+  static inline void initList(TimerNode *head) {
+    head->prev = head;
+    head->next = head;
+  }
+  static inline void append(TimerNode *head, TimerNode *n) {
+    n->prev = head->prev;
+    n->next = head;
+    head->prev->next = n;
+    head->prev = n;
+  }
+  static inline void prepend(TimerNode *head, TimerNode *n) {
+    n->prev = head;
+    n->next = head->next;
+    head->next->prev = n;
+    head->next = n;
+  }
+  static inline bool isEmpty(const TimerNode *head) {
+    return head->next == head;
+  }
+  static inline void unlink(TimerNode *n) {
+    n->prev->next = n->next;
+    n->next->prev = n->prev;
+    n->prev = nullptr;
+    n->next = nullptr;
+  }
+  // moves all entries of src to the tail of dst, keeping their order.
+  static inline void splice(TimerNode *dst, TimerNode *src) {
+    if (src->next == src) {
+      return;
+    }
+    src->next->prev = dst->prev;
+    dst->prev->next = src->next;
+    src->prev->next = dst;
+    dst->prev = src->prev;
+    initList(src);
+  }
+  // slot list node n belongs in, or the due list if it has expired.
+  inline TimerNode *slotFor(TimerNode *n) {
+    time_t delta = n->deadline - m_now;
+    if (delta <= 0) {
+      return &m_due;
+    }
+    int level = 0;
+    while (level < TW_LEVELS - 1 &&
+           delta >= (static_cast<time_t>(1) << (TW_LEVEL_BITS * (level + 1)))) {
+      level++;
+    }
+    time_t when = n->deadline;
+    time_t range = static_cast<time_t>(1) << (TW_LEVEL_BITS * TW_LEVELS);
+    if (delta >= range) {
+      // beyond the wheel's horizon; re-placed on cascade until in range.
+      when = m_now + range - 1;
+    }
+    return &m_slots[level][(when >> (TW_LEVEL_BITS * level)) & TW_SLOT_MASK];
+  }
+  inline void place(TimerNode *n) { append(slotFor(n), n); }
+  // re-places the entries of the level's current slot. Walking them from
+  // the tail and prepending keeps their order ahead of newer entries in the
+  // target slots; entries due now go behind those already due.
+  inline void cascade(int level) {
+    TimerNode pending;
+    TimerNode due;
+    initList(&pending);
+    initList(&due);
+    splice(&pending,
+           &m_slots[level][(m_now >> (TW_LEVEL_BITS * level)) & TW_SLOT_MASK]);
+    while (!isEmpty(&pending)) {
+      TimerNode *n = pending.prev;
+      unlink(n);
+      TimerNode *head = slotFor(n);
+      prepend(head == &m_due ? &due : head, n);
+    }
+    splice(&m_due, &due);
+  }
+  inline bool isLevelEmpty(int level) {
+    for (int s = 0; s < TW_SLOTS; s++) {
+      if (!isEmpty(&m_slots[level][s])) {
+        return false;
+      }
+    }
+    return true;
+  }
+  // first second after m_now, and no later than limit, at which a tick has
+  // work to do: a non-empty level-0 slot, or a boundary that cascades a
+  // level holding entries.
+  inline time_t nextTick(time_t limit) {
+    int level = 0;
+    while (level < TW_LEVELS && isLevelEmpty(level)) {
+      level++;
+    }
+    if (level == TW_LEVELS) {
+      return limit;
+    }
+    int bits = TW_LEVEL_BITS * (level > 0 ? level : 1);
+    time_t boundary = ((m_now >> bits) + 1) << bits;
+    if (level > 0) {
+      return boundary < limit ? boundary : limit;
+    }
+    time_t t = m_now + 1;
+    while (t < boundary && t < limit &&
+           isEmpty(&m_slots[0][t & TW_SLOT_MASK])) {
+      t++;
+    }
+    return t;
+  }
+  inline void tick() {
+    m_now++;
+    int top = 1;
+    while (top < TW_LEVELS &&
+           (m_now & ((static_cast<time_t>(1) << (TW_LEVEL_BITS * top)) - 1)) ==
+               0) {
+      top++;
+    }
+    for (int level = top - 1; level >= 1; level--) {
+      cascade(level);
+    }
+    splice(&m_due, &m_slots[0][m_now & TW_SLOT_MASK]);
+  }
+
+public:
+  TimerWheel() : m_now(0), m_size(0), m_started(false) {
+    for (int l = 0; l < TW_LEVELS; l++) {
+      for (int s = 0; s < TW_SLOTS; s++) {
+        initList(&m_slots[l][s]);
+      }
+    }
+    initList(&m_due);
+  }
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  // arms node to expire once the wheel reaches deadline, re-arming it if it
+  // is already scheduled.
+  inline void schedule(T *node, time_t deadline) {
+    if (node->isArmed()) {
+      unlink(node);
+      m_size--;
+    }
+    if (!m_started) {
+      m_now = deadline - 1;
+      m_started = true;
+    }
+    node->deadline = deadline;
+    place(node);
+    m_size++;
+  }
+  // returns false if node was not armed.
+  inline bool cancel(T *node) {
+    if (!node->isArmed()) {
+      return false;
+    }
+    unlink(node);
+    m_size--;
+    return true;
+  }
+  // turns the wheel up to now, moving every entry with deadline <= now to the
+  // due list.
+  inline void advance(time_t now) {
+    if (!m_started || m_size == 0) {
+      if (!m_started || now > m_now) {
+        m_now = now;
+      }
+      m_started = true;
+      return;
+    }
+    while (m_now < now) {
+      m_now = nextTick(now) - 1;
+      tick();
+    }
+  }
+  // pops the next expired entry, or returns nullptr if none is due.
+  inline T *popExpired() {
+    if (m_due.next == &m_due) {
+      return nullptr;
+    }
+    TimerNode *n = m_due.next;
+    unlink(n);
+    m_size--;
+    return static_cast<T *>(n);
+  }
+  inline size_t size() { return m_size; }
+};
+} // namespace timer
+#endif
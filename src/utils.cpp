@@ -25,6 +25,8 @@
 
 static NFKey s_nfdelkey;
 static NFKey s_nfemptykey;
+static FFKey s_ffdelkey;
+static FFKey s_ffemptykey;
 static bool s_keysinit = false;
 static OID s_oiddelkey;
 static OID s_oidemptykey;
@@ -32,14 +34,26 @@ static OID s_oidemptykey;
 CREATE_LOGGER_2("sysflow.utils");
 
 void initKeys() {
-  s_nfdelkey.ip1 = 1;
-  s_nfdelkey.ip2 = 1;
+  // no thread has tid -1 or -2, so these never collide with a real flow.
+  s_nfdelkey.tid = UINT64_MAX - 1;
+  s_nfdelkey.fd = 0;
+  s_nfdelkey.ip1 = nfaddr4(1);
+  s_nfdelkey.ip2 = nfaddr4(1);
   s_nfdelkey.port1 = 1;
   s_nfdelkey.port2 = 1;
-  s_nfemptykey.ip1 = 1;
-  s_nfemptykey.ip2 = 0;
+  s_nfemptykey.tid = UINT64_MAX;
+  s_nfemptykey.fd = 0;
+  s_nfemptykey.ip1 = nfaddr4(1);
+  s_nfemptykey.ip2 = nfaddr4(0);
   s_nfemptykey.port1 = 1;
   s_nfemptykey.port2 = 1;
+  // file ids start at 1.
+  s_ffemptykey.fileid = 0;
+  s_ffemptykey.tid = 0;
+  s_ffemptykey.fd = 0;
+  s_ffdelkey.fileid = 0;
+  s_ffdelkey.tid = -1;
+  s_ffdelkey.fd = -1;
   s_oidemptykey.hpid = 2;
   s_oidemptykey.createTS = 2;
   s_oiddelkey.hpid = 1;
@@ -66,41 +80,42 @@ NFKey *utils::getNFDelKey() {
   return &s_nfdelkey;
 }
 
-OID *utils::getOIDEmptyKey() {
+FFKey *utils::getFFEmptyKey() {
   if (!s_keysinit) {
     initKeys();
   }
-  return &s_oidemptykey;
+  return &s_ffemptykey;
 }
 
-OID *utils::getOIDDelKey() {
+FFKey *utils::getFFDelKey() {
   if (!s_keysinit) {
     initKeys();
   }
-  return &s_oiddelkey;
+  return &s_ffdelkey;
 }
 
-string utils::getUserName(context::SysFlowContext *cxt, uint32_t uid) {
-  scap_userinfo *user = cxt->getInspector()->get_user(uid);
-  if (user != nullptr) {
-    return user->name;
-  } else {
-    return string("");
+OID *utils::getOIDEmptyKey() {
+  if (!s_keysinit) {
+    initKeys();
   }
+  return &s_oidemptykey;
 }
 
-string utils::getGroupName(context::SysFlowContext *cxt, uint32_t gid) {
-  unordered_map<uint32_t, scap_groupinfo *>::const_iterator it;
-  if (gid == 0xffffffff) {
-    return string("");
+OID *utils::getOIDDelKey() {
+  if (!s_keysinit) {
+    initKeys();
   }
+  return &s_oiddelkey;
+}
 
-  it = cxt->getInspector()->m_grouplist.find(gid);
-  if (it == cxt->getInspector()->m_grouplist.end()) {
-    return string("");
-  }
+const string &utils::getUserName(context::SysFlowContext *cxt,
+                                 uint32_t uid) {
+  return cxt->getNameCache()->getUserName(uid, utils::getCurrentTime(cxt));
+}
 
-  return it->second->name;
+const string &utils::getGroupName(context::SysFlowContext *cxt,
+                                  uint32_t gid) {
+  return cxt->getNameCache()->getGroupName(gid, utils::getCurrentTime(cxt));
 }
 bool utils::isInContainer(sinsp_evt *ev) {
   sinsp_threadinfo *ti = ev->get_thread_info();
@@ -137,40 +152,42 @@ int64_t utils::getSyscallResult(sinsp_evt *ev) {
 }
 
 int64_t utils::getFlags(sinsp_evt *ev) {
-  return utils::getIntParam(ev, "flags");
+  return utils::getIntParam(ev, param::P_FLAGS);
 }
 
-int64_t utils::getFD(sinsp_evt *ev) { return utils::getIntParam(ev, "fd"); }
+int64_t utils::getFD(sinsp_evt *ev) {
+  return utils::getIntParam(ev, param::P_FD);
+}
 
 bool utils::isMapAnonymous(sinsp_evt *ev) {
   int64_t flags = utils::getFlags(ev);
   return flags & PPM_MAP_ANONYMOUS;
 }
 
-int64_t utils::getIntParam(sinsp_evt *ev, string pname) {
-  uint32_t n = ev->get_num_params();
-  for (uint32_t i = n; i >= 0; i--) {
-    string name = ev->get_param_name(i);
-    if (name.compare(pname) == 0) {
-      const ppm_param_info *param = ev->get_param_info(i);
-      switch (param->type) {
-      case PT_PID:
-      case PT_ERRNO:
-      case PT_FD:
-      case PT_INT64:
-      case PT_INT32:
-      case PT_FLAGS8:
-      case PT_FLAGS16:
-      case PT_FLAGS32: {
-        const sinsp_evt_param *p = ev->get_param(i);
-        return *reinterpret_cast<int64_t *>(p->m_val);
-      }
-      default:
-        return 0;
-      }
-    }
+int64_t utils::getIntParam(sinsp_evt *ev, param::ParamName name) {
+  const ppm_param_info *info = nullptr;
+  const sinsp_evt_param *p =
+      param::ParamIndex::instance().get(ev, name, &info);
+  if (p == nullptr) {
+    return 0;
+  }
+  switch (info->type) {
+  case PT_PID:
+  case PT_ERRNO:
+  case PT_FD:
+  case PT_INT64:
+    return *reinterpret_cast<int64_t *>(p->m_val);
+  case PT_INT32:
+    return *reinterpret_cast<int32_t *>(p->m_val);
+  case PT_FLAGS32:
+    return *reinterpret_cast<uint32_t *>(p->m_val);
+  case PT_FLAGS16:
+    return *reinterpret_cast<uint16_t *>(p->m_val);
+  case PT_FLAGS8:
+    return *reinterpret_cast<uint8_t *>(p->m_val);
+  default:
+    return 0;
   }
-  return 0;
 }
 
 bool utils::isCloneThreadSet(sinsp_evt *ev) {
@@ -232,105 +249,54 @@ int64_t utils::getSchemaVersion() {
   return -1;
 }
 
-string utils::getPath(sinsp_evt *ev, const string &paraName) {
-  int numParams = ev->get_num_params();
+string utils::getPath(sinsp_evt *ev, param::ParamName name) {
   string path;
-  for (int i = 0; i < numParams; i++) {
-    const ppm_param_info *param = ev->get_param_info(i);
-    string name = ev->get_param_name(i);
-    if (paraName.compare(name) != 0) {
-      continue;
-    }
-    const sinsp_evt_param *p = ev->get_param(i);
-    if (param->type == PT_FSPATH || param->type == PT_CHARBUF) {
-      path = string(p->m_val, p->m_len);
-      sanitize_string(path);
-    }
-    break;
+  const ppm_param_info *info = nullptr;
+  const sinsp_evt_param *p =
+      param::ParamIndex::instance().get(ev, name, &info);
+  if (p != nullptr &&
+      (info->type == PT_FSPATH || info->type == PT_CHARBUF)) {
+    path = string(p->m_val, p->m_len);
+    sanitize_string(path);
   }
   return path;
 }
 
-int64_t utils::getFD(sinsp_evt *ev, const string &paraName) {
-  int numParams = ev->get_num_params();
+int64_t utils::getFD(sinsp_evt *ev, param::ParamName name) {
   int64_t fd = -1;
-  for (int i = 0; i < numParams; i++) {
-    const ppm_param_info *param = ev->get_param_info(i);
-    string name = ev->get_param_name(i);
-    if (paraName.compare(name) != 0) {
-      continue;
-    }
-    const sinsp_evt_param *p = ev->get_param(i);
-    if (param->type == PT_FD) {
-      assert(p->m_len == sizeof(int64_t));
-      fd = (*reinterpret_cast<int64_t *>(p->m_val));
-    }
-    break;
+  const ppm_param_info *info = nullptr;
+  const sinsp_evt_param *p =
+      param::ParamIndex::instance().get(ev, name, &info);
+  if (p != nullptr && info->type == PT_FD) {
+    assert(p->m_len == sizeof(int64_t));
+    fd = (*reinterpret_cast<int64_t *>(p->m_val));
   }
   return fd;
 }
 
-fs::path utils::getCanonicalPath(const string &fileName) {
-  fs::path p(fileName);
-  try {
-    p = fs::weakly_canonical(p);
-  } catch (...) {
-    SF_WARN(m_logger, "Unable to compute canonical path from " << fileName);
-  }
-  return p;
-}
-
-string utils::getAbsolutePath(sinsp_threadinfo *ti, int64_t dirfd,
+string utils::getAbsolutePath(context::SysFlowContext *cxt,
+                              sinsp_threadinfo *ti, int64_t dirfd,
                               const string &fileName) {
-  fs::path p(fileName);
-  SF_DEBUG(m_logger, "getAbsolutePath: The path is "
-                         << p << " File name " << fileName << " is relative? "
-                         << p.is_relative());
-  if (fileName.empty() || p.is_relative()) {
-    fs::path tmp;
+  if (!fileName.empty() && fileName[0] == '/') {
+    return cxt->getPathCache()->canonicalize(string(), fileName);
+  }
+  if (dirfd == PPM_AT_FDCWD) {
     string cwd = ti->get_cwd();
-    if (dirfd == PPM_AT_FDCWD) {
-      if (cwd.empty()) {
-        return p.string();
-      }
-      tmp = ti->get_cwd();
-    } else {
-      sinsp_fdinfo_t *fdinfo = ti->get_fd(dirfd);
-      if (fdinfo == nullptr) {
-        return p.string();
-      }
-      tmp = fdinfo->m_name;
-      SF_DEBUG(m_logger,
-               "getAbsolutePath: Retrieve fdinfo for fd. Path:  " << tmp);
+    if (cwd.empty()) {
+      return fileName;
     }
-    tmp /= fileName;
-    SF_DEBUG(m_logger, "getAbsolutePath: Before canonicalization: " << tmp);
-    p = utils::getCanonicalPath(tmp);
-    SF_DEBUG(m_logger, "getAbsolutePath: The canonicalized file is " << p);
-  } else {
-    p = utils::getCanonicalPath(p);
+    return cxt->getPathCache()->canonicalize(cwd, fileName);
   }
-
-  return p.string();
+  sinsp_fdinfo_t *fdinfo = ti->get_fd(dirfd);
+  if (fdinfo == nullptr) {
+    return fileName;
+  }
+  SF_DEBUG(m_logger,
+           "getAbsolutePath: Retrieve fdinfo for fd. Path:  " << fdinfo->m_name);
+  return cxt->getPathCache()->canonicalize(fdinfo->m_name, fileName);
 }
 
-string utils::getAbsolutePath(sinsp_threadinfo *ti, const string &fileName) {
-  fs::path p(fileName);
-  SF_DEBUG(m_logger, "getAbsolutePath: The path is "
-                         << p << " File name " << fileName << " is relative? "
-                         << p.is_relative());
-  if (fileName.empty() || p.is_relative()) {
-    fs::path tmp;
-    string cwd = ti->get_cwd();
-    if (!cwd.empty()) {
-      tmp = cwd;
-      tmp /= fileName;
-      SF_DEBUG(m_logger, "getAbsolutePath: Before canonicalization: " << tmp);
-      p = utils::getCanonicalPath(tmp);
-      SF_DEBUG(m_logger, "getAbsolutePath: The canonicalized file is " << p);
-    }
-  } else {
-    p = utils::getCanonicalPath(p);
-  }
-  return p.string();
+string utils::getAbsolutePath(context::SysFlowContext *cxt,
+                              sinsp_threadinfo *ti, const string &fileName) {
+  return utils::getAbsolutePath(cxt, ti, PPM_AT_FDCWD, fileName);
 }
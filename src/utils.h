@@ -22,6 +22,7 @@
 #include "avro/Compiler.hh"
 #include "avro/ValidSchema.hh"
 #include "ghc/fs_std.hpp"
+#include "paramindex.h"
 #include "sysflow.h"
 #include "sysflowcontext.h"
 #include <ctime>
@@ -45,30 +46,33 @@ using sysflow::OID;
 
 typedef std::array<uint8_t, 20> FOID;
 struct NFKey;
+struct FFKey;
 
 namespace utils {
 int64_t getFlags(sinsp_evt *ev);
 bool isCloneThreadSet(sinsp_evt *ev);
 int64_t getFD(sinsp_evt *ev);
 bool isMapAnonymous(sinsp_evt *ev);
-int64_t getIntParam(sinsp_evt *ev, string pname);
-string getUserName(context::SysFlowContext *cxt, uint32_t uid);
-string getGroupName(context::SysFlowContext *cxt, uint32_t gid);
+int64_t getIntParam(sinsp_evt *ev, param::ParamName name);
+const string &getUserName(context::SysFlowContext *cxt, uint32_t uid);
+const string &getGroupName(context::SysFlowContext *cxt, uint32_t gid);
 bool isInContainer(sinsp_evt *ev);
 int64_t getSyscallResult(sinsp_evt *ev);
 avro::ValidSchema loadSchema();
 time_t getExportTime(context::SysFlowContext *cxt);
 NFKey *getNFDelKey();
 NFKey *getNFEmptyKey();
+FFKey *getFFDelKey();
+FFKey *getFFEmptyKey();
 OID *getOIDDelKey();
 OID *getOIDEmptyKey();
 void generateFOID(const string &key, FOID *foid);
-string getPath(sinsp_evt *ev, const string &paraName);
-fs::path getCanonicalPath(const string &fileName);
-string getAbsolutePath(sinsp_threadinfo *ti, int64_t dirfd,
+string getPath(sinsp_evt *ev, param::ParamName name);
+string getAbsolutePath(context::SysFlowContext *cxt, sinsp_threadinfo *ti,
+                       int64_t dirfd, const string &fileName);
+string getAbsolutePath(context::SysFlowContext *cxt, sinsp_threadinfo *ti,
                        const string &fileName);
-string getAbsolutePath(sinsp_threadinfo *ti, const string &fileName);
-int64_t getFD(sinsp_evt *ev, const string &paraName);
+int64_t getFD(sinsp_evt *ev, param::ParamName name);
 int64_t getSchemaVersion();
 
 inline time_t getCurrentTime(context::SysFlowContext *cxt) {
@@ -0,0 +1,52 @@
+#!/bin/bash
+#
+# Copyright (C) 2019 IBM Corporation.
+#
+# Authors:
+# Frederico Araujo <frederico.araujo@ibm.com>
+# Teryl Taylor <terylt@ibm.com>
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Replays the bundled traces with each compression codec and reports the
+# compression ratio and codec throughput (MB of uncompressed avro per second
+# spent compressing) as logged by the block writer.
+#
+# Usage: codec-benchmark.sh [codec ...]
+#   COMPRESS_LEVEL and COMPRESS_BLOCK_SIZE are passed through to sysporter.
+
+TDIR=${WDIR}/tests
+sysporter=${WDIR}/bin/sysporter
+exporter=tests
+codecs=${@:-null deflate snappy zstd}
+odir=$(mktemp -d)
+trap "rm -rf ${odir}" EXIT
+
+printf "%-40s %-8s %12s %12s %8s %10s %8s\n" "trace" "codec" "bytes in" "bytes out" "ratio" "MB/s" "wall(s)"
+for trace in ${TDIR}/*/*.scap; do
+  tname=$(basename $(dirname ${trace}))/$(basename ${trace} .scap)
+  for codec in ${codecs}; do
+    ofile=${odir}/$(basename ${trace} .scap).${codec}.sf
+    start=$(date +%s.%N)
+    stats=$(ENABLE_ASYNC_WRITER=1 COMPRESS_CODEC=${codec} GLOG_logtostderr=1 \
+      $sysporter -r ${trace} -w ${ofile} -e $exporter 2>&1 >/dev/null | grep "Codec:" | tail -1)
+    end=$(date +%s.%N)
+    bin=$(echo "${stats}" | sed -E 's/.*Bytes In: ([0-9]+).*/\1/')
+    bout=$(echo "${stats}" | sed -E 's/.*Bytes Out: ([0-9]+).*/\1/')
+    ratio=$(echo "${stats}" | sed -E 's/.*Ratio: ([0-9.e+-]+).*/\1/')
+    mbps=$(echo "${stats}" | sed -E 's/.*MB\/s: ([0-9.e+-]+).*/\1/')
+    wall=$(awk "BEGIN { print ${end} - ${start} }")
+    printf "%-40s %-8s %12s %12s %8.2f %10.1f %8.2f\n" ${tname} ${codec} ${bin:-0} ${bout:-0} ${ratio:-0} ${mbps:-0} ${wall}
+    rm -f ${ofile}
+  done
+done